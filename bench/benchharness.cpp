@@ -0,0 +1,170 @@
+#include "benchharness.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+namespace {
+std::atomic<std::uint64_t> allocations{0};
+volatile long long sink;
+}
+
+void *operator new(std::size_t size)
+{
+    allocations.fetch_add(1, std::memory_order_relaxed);
+    if (void *p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p) noexcept
+{
+    std::free(p);
+}
+
+void operator delete(void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+void operator delete[](void *p, std::size_t) noexcept
+{
+    std::free(p);
+}
+
+namespace bench {
+
+std::uint64_t allocationCount()
+{
+    return allocations.load(std::memory_order_relaxed);
+}
+
+void doNotOptimize(long long value)
+{
+    sink = value;
+}
+
+bool parseOptions(int argc, char *argv[], Options &options)
+{
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if (!std::strcmp(arg, "--min-size") && value) {
+            options.minSize = std::atoll(value);
+        } else if (!std::strcmp(arg, "--max-size") && value) {
+            options.maxSize = std::atoll(value);
+        } else if (!std::strcmp(arg, "--budget-ms") && value) {
+            options.budgetMs = std::atof(value);
+        } else if (!std::strcmp(arg, "--out") && value) {
+            options.outputPath = value;
+        } else if (!std::strcmp(arg, "--filter") && value) {
+            options.filter = value;
+        } else {
+            std::fprintf(stderr,
+                         "usage: %s [--min-size N] [--max-size N] [--budget-ms MS]"
+                         " [--out FILE.csv] [--filter SUBSTRING]\n", argv[0]);
+            return false;
+        }
+        i++;
+    }
+    return true;
+}
+
+std::vector<long long> sizeSweep(const Options &options)
+{
+    std::vector<long long> sizes;
+    for (long long n = 10; n <= options.maxSize; n *= 10) {
+        if (n >= options.minSize) {
+            sizes.push_back(n);
+        }
+    }
+    return sizes;
+}
+
+Runner::Runner(const Options &options)
+    : opts(options)
+{
+}
+
+bool Runner::enabled(const std::string &name) const
+{
+    return opts.filter.empty() || name.find(opts.filter) != std::string::npos;
+}
+
+void Runner::run(const std::string &name, long long size, long long maxOps,
+                 const std::function<void()> &setup,
+                 const std::function<void(long long)> &body)
+{
+    if (!enabled(name) || maxOps <= 0) return;
+
+    setup();
+
+    using Clock = std::chrono::steady_clock;
+    const auto budget = std::chrono::duration<double, std::milli>(opts.budgetMs);
+    long long done = 0;
+    long long batch = 1;
+    std::chrono::nanoseconds elapsed{0};
+    const std::uint64_t allocsBefore = allocationCount();
+
+    while (done < maxOps && elapsed < budget) {
+        const long long end = std::min(maxOps, done + batch);
+        const auto start = Clock::now();
+        for (long long i = done; i < end; i++) {
+            body(i);
+        }
+        elapsed += Clock::now() - start;
+        done = end;
+        batch *= 2;
+    }
+
+    const std::uint64_t allocs = allocationCount() - allocsBefore;
+    add(Result{name, size, done,
+               double(elapsed.count()) / double(done),
+               double(allocs) / double(done)});
+}
+
+void Runner::add(const Result &result)
+{
+    std::printf("%-28s n=%-10lld ops=%-10lld %12.1f ns/op %8.2f allocs/op\n",
+                result.name.c_str(), result.size, result.ops,
+                result.nsPerOp, result.allocsPerOp);
+    std::fflush(stdout);
+    collected.push_back(result);
+}
+
+const std::vector<Result> &Runner::results() const
+{
+    return collected;
+}
+
+bool Runner::writeCsv() const
+{
+    FILE *out = std::fopen(opts.outputPath.c_str(), "w");
+    if (!out) {
+        std::fprintf(stderr, "cannot write %s\n", opts.outputPath.c_str());
+        return false;
+    }
+    std::fprintf(out, "benchmark,size,ops,ns_per_op,allocs_per_op\n");
+    for (const Result &r : collected) {
+        std::fprintf(out, "%s,%lld,%lld,%.3f,%.4f\n",
+                     r.name.c_str(), r.size, r.ops, r.nsPerOp, r.allocsPerOp);
+    }
+    std::fclose(out);
+    std::printf("Wrote %zu results to %s\n", collected.size(), opts.outputPath.c_str());
+    return true;
+}
+
+} // namespace bench
@@ -0,0 +1,68 @@
+#ifndef BENCHHARNESS_H
+#define BENCHHARNESS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+// Minimal micro-benchmark harness shared by the dsv benchmark targets.
+// Counts heap allocations by replacing the global operator new.
+namespace bench {
+
+struct Result {
+    std::string name;
+    long long size;
+    long long ops;
+    double nsPerOp;
+    double allocsPerOp;
+};
+
+struct Options {
+    long long minSize = 10;
+    long long maxSize = 10000000;
+    double budgetMs = 200.0;
+    std::string outputPath = "dsv_bench.csv";
+    std::string filter;
+};
+
+std::uint64_t allocationCount();
+
+// Parses --min-size, --max-size, --budget-ms, --out and --filter.
+// Returns false (after printing usage) on unknown arguments.
+bool parseOptions(int argc, char *argv[], Options &options);
+
+// Sizes 10, 100, ... within [minSize, maxSize]
+std::vector<long long> sizeSweep(const Options &options);
+
+class Runner
+{
+public:
+    explicit Runner(const Options &options);
+
+    bool enabled(const std::string &name) const;
+
+    // Runs body(i) for i in [0, maxOps) in batches until the time budget is
+    // spent; setup() runs once beforehand and is not timed.
+    void run(const std::string &name, long long size, long long maxOps,
+             const std::function<void()> &setup,
+             const std::function<void(long long)> &body);
+
+    // Records a measurement taken by the caller
+    void add(const Result &result);
+
+    const std::vector<Result> &results() const;
+    bool writeCsv() const;
+
+private:
+    Options opts;
+    std::vector<Result> collected;
+};
+
+// Prevents the optimizer from discarding a computed value
+void doNotOptimize(long long value);
+
+} // namespace bench
+
+#endif // BENCHHARNESS_H
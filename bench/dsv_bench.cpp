@@ -0,0 +1,419 @@
+// Micro-benchmarks for the headless dsv_core engines.
+//
+// Every hot operation is measured at sizes 10, 100, ... 10^7 and reported as
+// ns/op and heap allocations/op. Results are written as CSV (--out) so runs
+// from different releases can be diffed.
+
+#include "benchharness.h"
+#include "chaselevdeque.h"
+#include "columnevaluator.h"
+#include "conversiontrace.h"
+#include "operationhistory.h"
+#include "operationtrace.h"
+#include "postfixevaluator.h"
+#include "queueengine.h"
+#include "sessionlog.h"
+#include "shuntingyard.h"
+#include "spscring.h"
+#include "stackengine.h"
+#include "tokenizer.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Upper bound on ints copied by the O(n) state-copy cases, so the large
+// sizes finish in bounded time and memory
+const long long COPY_BUDGET = 1LL << 25;
+const long long LOOKUP_OPS = 10000000;
+const std::size_t HISTORY_BUDGET = std::size_t(1) << 34;
+
+long long copyBoundedOps(long long n)
+{
+    return std::max(1LL, std::min(n, COPY_BUDGET / n));
+}
+
+// Deterministic expression with n operands, e.g. "A+B*(C-D)/E^F..."
+std::string makeExpression(long long n)
+{
+    static const char operators[] = {'+', '*', '-', '/', '^'};
+    std::string expr;
+    expr.reserve(n * 3);
+    bool open = false;
+    for (long long i = 0; i < n; i++) {
+        if (i % 7 == 2 && i + 1 < n) {
+            expr += '(';
+            open = true;
+        }
+        expr += char('A' + i % 26);
+        if (open && i % 7 == 3) {
+            expr += ')';
+            open = false;
+        }
+        if (i + 1 < n) {
+            expr += operators[i % 5];
+        }
+    }
+    if (open) {
+        expr += ')';
+    }
+    return expr;
+}
+
+void benchStack(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<StackEngine> stack;
+    auto prefilled = [&](long long capacity) {
+        stack.reset(new StackEngine(int(capacity)));
+        stack->setHistoryEnabled(false);
+        stack->setHistoryBudget(HISTORY_BUDGET);
+        for (long long i = 0; i < n; i++) {
+            stack->push(int(i));
+        }
+    };
+
+    runner.run("stack.push", n, n, [&] { prefilled(2 * n); },
+               [&](long long i) { stack->push(int(i)); });
+    runner.run("stack.pop", n, n, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(stack->pop()); });
+    runner.run("stack.peek", n, LOOKUP_OPS, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(stack->peek()); });
+    runner.run("stack.getCurrentState", n, copyBoundedOps(n), [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(long(stack->getCurrentState().size())); });
+
+    const long long historyOps = n;
+    runner.run("stack.push+history", n, historyOps,
+               [&] { prefilled(n + historyOps); stack->setHistoryEnabled(true); },
+               [&](long long i) { stack->push(int(i)); });
+    runner.run("stack.undo", n, historyOps,
+               [&] {
+                   prefilled(n + historyOps);
+                   stack->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) stack->push(int(i));
+               },
+               [&](long long) { stack->undo(); });
+    runner.run("stack.redo", n, historyOps,
+               [&] {
+                   prefilled(n + historyOps);
+                   stack->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) stack->push(int(i));
+                   while (stack->undo()) {}
+               },
+               [&](long long) { stack->redo(); });
+    runner.run("stack.seek", n, LOOKUP_OPS / 10,
+               [&] {
+                   prefilled(n + historyOps);
+                   stack->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) {
+                       if (i % 3 == 2) stack->pop(); else stack->push(int(i));
+                   }
+               },
+               [&](long long i) { stack->seek(int((i * 7919) % historyOps)); });
+    stack.reset();
+}
+
+void benchQueue(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<QueueEngine> queue;
+    auto prefilled = [&](long long capacity) {
+        queue.reset(new QueueEngine(int(capacity)));
+        queue->setHistoryEnabled(false);
+        queue->setHistoryBudget(HISTORY_BUDGET);
+        for (long long i = 0; i < n; i++) {
+            queue->enqueue(int(i));
+        }
+    };
+
+    runner.run("queue.enqueue", n, n, [&] { prefilled(2 * n); },
+               [&](long long i) { queue->enqueue(int(i)); });
+    runner.run("queue.dequeue", n, n, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(queue->dequeue()); });
+    runner.run("queue.front", n, LOOKUP_OPS, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(queue->front()); });
+    runner.run("queue.rear", n, LOOKUP_OPS, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(queue->rear()); });
+    runner.run("queue.getCurrentState", n, copyBoundedOps(n), [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(long(queue->getCurrentState().size())); });
+
+    const long long historyOps = n;
+    runner.run("queue.enqueue+history", n, historyOps,
+               [&] { prefilled(n + historyOps); queue->setHistoryEnabled(true); },
+               [&](long long i) { queue->enqueue(int(i)); });
+    runner.run("queue.undo", n, historyOps,
+               [&] {
+                   prefilled(n + historyOps);
+                   queue->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) queue->enqueue(int(i));
+               },
+               [&](long long) { queue->undo(); });
+    runner.run("queue.redo", n, historyOps,
+               [&] {
+                   prefilled(n + historyOps);
+                   queue->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) queue->enqueue(int(i));
+                   while (queue->undo()) {}
+               },
+               [&](long long) { queue->redo(); });
+    queue.reset();
+}
+
+void benchHistory(bench::Runner &runner, long long n)
+{
+    // addToHistory: one log entry plus the engines' checkpoint policy for an
+    // n-element state
+    std::unique_ptr<OperationHistory> history;
+    std::vector<int> state;
+    runner.run("history.record", n, std::max(n, 1000LL),
+               [&] {
+                   history.reset(new OperationHistory);
+                   history->setMemoryBudget(HISTORY_BUDGET);
+                   state.assign(size_t(n), 1);
+               },
+               [&](long long i) {
+                   history->record(Operation{Operation::Insert, int(i)});
+                   if (history->wantsCheckpoint(int(n))) {
+                       history->addCheckpoint(state);
+                   }
+               });
+    history.reset();
+}
+
+// Uncontended cost of the ring's push/pop pair, ring holding n items
+void benchSpsc(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<SpscRing<int>> ring;
+    runner.run("spsc.push+pop", n, LOOKUP_OPS,
+               [&] {
+                   ring.reset(new SpscRing<int>(std::size_t(n) + 1));
+                   for (long long i = 0; i < n; i++) ring->tryPush(int(i));
+               },
+               [&](long long i) {
+                   int value = 0;
+                   ring->tryPush(int(i));
+                   ring->tryPop(value);
+                   bench::doNotOptimize(value);
+               });
+}
+
+// Owner-side push/take on a work-stealing deque holding n items
+void benchWorkStealing(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<ChaseLevDeque<int>> deque;
+    runner.run("deque.push+take", n, LOOKUP_OPS,
+               [&] {
+                   deque.reset(new ChaseLevDeque<int>);
+                   for (long long i = 0; i < n; i++) deque->push(int(i));
+               },
+               [&](long long i) {
+                   int value = 0;
+                   deque->push(int(i));
+                   deque->take(value);
+                   bench::doNotOptimize(value);
+               });
+}
+
+// Replays a push/pop trace from a memory-mapped file into a StackEngine,
+// parsing straight out of the mapping. The trace file is capped so the
+// large sizes do not write hundreds of megabytes to disk
+void benchTraceReplay(bench::Runner &runner, long long n)
+{
+    const long long lines = std::min(n, 1LL << 20);
+    const std::string path = "dsv_bench_trace.tmp";
+    std::FILE *out = std::fopen(path.c_str(), "w");
+    if (!out) return;
+    for (long long i = 0; i < lines; i++) {
+        if (i % 3 == 2) {
+            std::fputs("pop\n", out);
+        } else {
+            std::fprintf(out, "push %lld\n", i);
+        }
+    }
+    std::fclose(out);
+
+    OperationTrace trace;
+    StackEngine engine;
+    if (trace.open(path, nullptr)) {
+        engine.setHistoryEnabled(false);
+        engine.setCapacity(std::max(1, trace.peakSize()));
+        runner.run("trace.replay", n, LOOKUP_OPS,
+                   [&] {
+                       trace.rewind();
+                       engine.clear();
+                   },
+                   [&](long long) {
+                       Operation op;
+                       if (!trace.next(op)) {
+                           trace.rewind();
+                           engine.clear();
+                           return;
+                       }
+                       if (op.type == Operation::Insert) {
+                           engine.push(op.value);
+                       } else {
+                           bench::doNotOptimize(engine.pop());
+                       }
+                   });
+        trace.close();
+    }
+    std::remove(path.c_str());
+}
+
+// Per-operation recording cost, and seeking into an n-record session log
+void benchSession(bench::Runner &runner, long long n)
+{
+    const std::string path = "dsv_bench_session.tmp";
+    SessionWriter writer;
+    runner.run("session.record", n, LOOKUP_OPS,
+               [&] { writer.open(path, SessionLog::Stack); },
+               [&](long long i) { writer.record(EngineEvent::Inserted, Operation::Insert, int(i)); });
+    writer.close();
+
+    if (writer.open(path, SessionLog::Stack)) {
+        for (long long i = 0; i < n; i++) writer.record(EngineEvent::Inserted, Operation::Insert, int(i));
+        writer.close();
+    }
+    SessionReader reader;
+    if (reader.open(path, nullptr)) {
+        runner.run("session.seek+next", n, LOOKUP_OPS, [] {},
+                   [&](long long i) {
+                       SessionLog::Record record{};
+                       reader.seek(std::uint64_t((i * 7919) % n));
+                       reader.next(record);
+                       bench::doNotOptimize(record.value);
+                   });
+        reader.close();
+    }
+    std::remove(path.c_str());
+}
+
+void benchInfix(bench::Runner &runner, long long n)
+{
+    const std::string expr = makeExpression(n);
+    runner.run("infix.tokenize", n, std::max(1LL, LOOKUP_OPS / n), [] {},
+               [&](long long) {
+                   Tokenizer tokenizer(expr);
+                   Token token;
+                   long count = 0;
+                   while (tokenizer.next(token)) count++;
+                   bench::doNotOptimize(count);
+               });
+    runner.run("infix.convert", n, std::max(1LL, LOOKUP_OPS / n), [] {},
+               [&](long long) { bench::doNotOptimize(long(ShuntingYard::convert(expr).size())); });
+
+    // The same conversion split across 1, 2, 4 ... threads up to the core
+    // count, with its speedup over infix.convert
+    const auto lastNsPerOp = [&](const std::string &name) {
+        const std::vector<bench::Result> &results = runner.results();
+        for (auto it = results.rbegin(); it != results.rend(); ++it) {
+            if (it->name == name && it->size == n) return it->nsPerOp;
+        }
+        return 0.0;
+    };
+    const int cores = std::max(1, int(std::thread::hardware_concurrency()));
+    for (int threads = 1;; threads = std::min(threads * 2, cores)) {
+        const std::string name = "infix.convert.parallel." + std::to_string(threads);
+        runner.run(name, n, std::max(1LL, LOOKUP_OPS / n), [] {},
+                   [&](long long) { bench::doNotOptimize(long(ShuntingYard::convertParallel(expr, threads).size())); });
+        const double sequentialNs = lastNsPerOp("infix.convert");
+        const double parallelNs = lastNsPerOp(name);
+        if (sequentialNs > 0.0 && parallelNs > 0.0) {
+            std::printf("%-28s n=%-10lld %d/%d cores %8.2fx speedup\n", name.c_str(), n, threads, cores,
+                        sequentialNs / parallelNs);
+        }
+        if (threads == cores) break;
+    }
+
+    // Mapped file to file, including the open and the final write
+    const std::string inputPath = "dsv_bench_infix.tmp";
+    const std::string outputPath = "dsv_bench_postfix.tmp";
+    if (std::FILE *file = std::fopen(inputPath.c_str(), "wb")) {
+        const bool written = std::fwrite(expr.data(), 1, expr.size(), file) == expr.size();
+        if (std::fclose(file) == 0 && written) {
+            runner.run("infix.convert.file", n, std::max(1LL, LOOKUP_OPS / n), [] {},
+                       [&](long long) {
+                           ShuntingYard::FileStats stats;
+                           ShuntingYard::convertFile(inputPath, outputPath, &stats);
+                           bench::doNotOptimize(long(stats.outputBytes));
+                       });
+        }
+    }
+    std::remove(inputPath.c_str());
+    std::remove(outputPath.c_str());
+
+    // Recording the step trace, and restoring the stack at a random step
+    ConversionTrace trace;
+    runner.run("infix.trace.record", n, std::max(1LL, LOOKUP_OPS / n), [] {},
+               [&](long long) {
+                   trace.record(expr);
+                   bench::doNotOptimize(long(trace.stepCount()));
+               });
+    trace.record(expr);
+    std::vector<Token> stack;
+    runner.run("infix.trace.seek", n, LOOKUP_OPS / 10, [] {},
+               [&](long long i) {
+                   trace.operatorStack(int((i * 7919) % (trace.stepCount() + 1)), stack);
+                   bench::doNotOptimize(long(stack.size()));
+               });
+
+    PostfixEvaluator evaluator;
+    evaluator.compile(ShuntingYard::convert(expr));
+    const std::vector<double> values(evaluator.variables().size(), 1.5);
+    runner.run("postfix.evaluate", n, std::max(1LL, LOOKUP_OPS / n), [] {},
+               [&](long long) { bench::doNotOptimize(long(evaluator.evaluate(values.data()) != 0.0)); });
+}
+
+// One fixed expression evaluated over n rows of column data
+void benchColumns(bench::Runner &runner, long long n)
+{
+    PostfixEvaluator program;
+    program.compile(ShuntingYard::convert("(A+B)*C-D/E"));
+    std::vector<std::vector<double>> data(program.variables().size(), std::vector<double>(n));
+    std::vector<const double *> columns;
+    for (std::size_t c = 0; c < data.size(); c++) {
+        for (long long i = 0; i < n; i++) {
+            data[c][i] = 1.0 + double((i * 7 + c * 13) % 101);
+        }
+        columns.push_back(data[c].data());
+    }
+    std::vector<double> out(n);
+
+    const ColumnEvaluator::Isa isas[] = {ColumnEvaluator::Scalar, ColumnEvaluator::SSE2, ColumnEvaluator::AVX2};
+    for (ColumnEvaluator::Isa isa : isas) {
+        if (isa > ColumnEvaluator::detectIsa()) break;
+        ColumnEvaluator columnEvaluator(isa);
+        const std::string name = std::string("postfix.columns.") + ColumnEvaluator::isaName(isa);
+        runner.run(name, n, copyBoundedOps(n), [] {}, [&](long long) {
+            columnEvaluator.evaluate(program, columns.data(), std::size_t(n), out.data());
+            bench::doNotOptimize(long(out[n - 1] != 0.0));
+        });
+    }
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    bench::Options options;
+    if (!bench::parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    bench::Runner runner(options);
+    for (long long n : bench::sizeSweep(options)) {
+        benchStack(runner, n);
+        benchQueue(runner, n);
+        benchSpsc(runner, n);
+        benchWorkStealing(runner, n);
+        benchHistory(runner, n);
+        benchTraceReplay(runner, n);
+        benchSession(runner, n);
+        benchInfix(runner, n);
+        benchColumns(runner, n);
+    }
+
+    return runner.writeCsv() ? 0 : 1;
+}
@@ -0,0 +1,190 @@
+// Rendering scalability of the visualizer scenes. Each visualizer is filled
+// with n elements and its QGraphicsScene rendered into a QImage with
+// QGraphicsScene::render, under the offscreen platform so it runs on CI
+// machines without a display. Scene build and paint are reported as
+// separate rows in the dsv_bench CSV format:
+//
+//     render.<view>.build        filling the widget to n elements, once
+//     render.<view>.paint.first  first render, including the scene index
+//     render.<view>.paint        steady-state render of the whole scene
+//
+// --max-paint-ms MS makes the run fail when any steady-state paint is
+// slower, for use as a release gate.
+
+#include "benchharness.h"
+#include "infixtopostfix.h"
+#include "queuevisualizer.h"
+#include "stackvisualizer.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <QGraphicsScene>
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <vector>
+
+namespace {
+
+const int IMAGE_WIDTH = 1920;
+const int IMAGE_HEIGHT = 1080;
+const long long MAX_PAINTS = 1000;
+
+// Lets push/enqueue fade-ins finish so every item is painted opaque
+void settleAnimations()
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 400) {
+        QApplication::processEvents(QEventLoop::AllEvents, 50);
+    }
+}
+
+void renderScene(QGraphicsScene *scene, QImage &image)
+{
+    image.fill(Qt::white);
+    QPainter painter(&image);
+    painter.setRenderHint(QPainter::Antialiasing);
+    scene->render(&painter, QRectF(image.rect()), scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+}
+
+double worstPaintMs = 0.0;
+
+// build() fills the widget and returns its scene; it is timed once
+void benchScene(bench::Runner &runner, const std::string &prefix, long long n,
+                const std::function<QGraphicsScene *()> &build)
+{
+    const std::string buildName = prefix + ".build";
+    const std::string firstName = prefix + ".paint.first";
+    const std::string paintName = prefix + ".paint";
+    if (!runner.enabled(buildName) && !runner.enabled(firstName) && !runner.enabled(paintName)) return;
+
+    QImage image(IMAGE_WIDTH, IMAGE_HEIGHT, QImage::Format_ARGB32_Premultiplied);
+    QElapsedTimer timer;
+    std::uint64_t allocs = bench::allocationCount();
+    timer.start();
+    QGraphicsScene *scene = build();
+    const qint64 buildNs = timer.nsecsElapsed();
+    allocs = bench::allocationCount() - allocs;
+    if (runner.enabled(buildName)) {
+        runner.add(bench::Result{buildName, n, 1, double(buildNs), double(allocs)});
+    }
+    settleAnimations();
+
+    allocs = bench::allocationCount();
+    timer.start();
+    renderScene(scene, image);
+    const qint64 firstNs = timer.nsecsElapsed();
+    allocs = bench::allocationCount() - allocs;
+    if (runner.enabled(firstName)) {
+        runner.add(bench::Result{firstName, n, 1, double(firstNs), double(allocs)});
+    }
+
+    const std::size_t before = runner.results().size();
+    runner.run(paintName, n, MAX_PAINTS, [] {}, [&](long long) { renderScene(scene, image); });
+    if (runner.results().size() > before) {
+        worstPaintMs = std::max(worstPaintMs, runner.results().back().nsPerOp / 1e6);
+    }
+}
+
+void benchStack(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<StackVisualizer> stack;
+    benchScene(runner, "render.stack", n, [&] {
+        stack.reset(new StackVisualizer);
+        stack->resize(1024, 768);
+        stack->show();
+        stack->setCapacity(int(n));
+        stack->setHistoryEnabled(false);
+        for (long long i = 0; i < n; i++) {
+            stack->push(int(i));
+        }
+        return stack->graphicsScene();
+    });
+}
+
+void benchQueue(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<QueueVisualizer> queue;
+    benchScene(runner, "render.queue", n, [&] {
+        queue.reset(new QueueVisualizer);
+        queue->resize(1024, 768);
+        queue->show();
+        queue->setCapacity(int(n));
+        queue->setHistoryEnabled(false);
+        for (long long i = 0; i < n; i++) {
+            queue->enqueue(int(i));
+        }
+        return queue->graphicsScene();
+    });
+}
+
+// "A+(B+(C+...": stopping before the closing parentheses leaves every
+// operator and parenthesis on the stack and every operand in the output
+void benchInfix(bench::Runner &runner, long long n)
+{
+    QString open;
+    for (long long i = 0; i < n; i++) {
+        if (i > 0) open += i + 1 < n ? "+(" : "+";
+        open += QChar(char16_t('A' + i % 26));
+    }
+    const QString expression = open + QString(int(std::max(0LL, n - 2)), ')');
+
+    std::unique_ptr<InfixToPostfix> infix;
+    benchScene(runner, "render.infix", n, [&] {
+        infix.reset(new InfixToPostfix);
+        infix->resize(1024, 768);
+        infix->show();
+        infix->setExpression(expression);
+        infix->startConversion();
+        infix->advanceConversion(open.size());
+        return infix->graphicsScene();
+    });
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    // Strip our own gate option before the shared harness parses the rest
+    double maxPaintMs = 0.0;
+    std::vector<char *> args;
+    for (int i = 0; i < argc; i++) {
+        if (!std::strcmp(argv[i], "--max-paint-ms") && i + 1 < argc) {
+            maxPaintMs = std::atof(argv[++i]);
+        } else {
+            args.push_back(argv[i]);
+        }
+    }
+
+    bench::Options options;
+    options.maxSize = 100000;
+    options.outputPath = "dsv_render_bench.csv";
+    if (!bench::parseOptions(int(args.size()), args.data(), options)) {
+        return 2;
+    }
+
+    bench::Runner runner(options);
+    for (long long n : bench::sizeSweep(options)) {
+        benchStack(runner, n);
+        benchQueue(runner, n);
+        benchInfix(runner, n);
+    }
+
+    if (!runner.writeCsv()) return 1;
+    if (maxPaintMs > 0.0 && worstPaintMs > maxPaintMs) {
+        std::fprintf(stderr, "Slowest paint took %.2f ms, over the %.2f ms budget\n", worstPaintMs, maxPaintMs);
+        return 1;
+    }
+    return 0;
+}
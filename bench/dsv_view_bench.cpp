@@ -0,0 +1,111 @@
+// Per-operation cost of the visualizer widgets, including their scene
+// updates, measured under the offscreen platform so it runs without a
+// display. Uses the same harness and CSV format as dsv_bench.
+
+#include "benchharness.h"
+#include "queuevisualizer.h"
+#include "stackvisualizer.h"
+
+#include <QApplication>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <memory>
+
+namespace {
+
+// Lets the 100 ms animation timer finish; undo/redo are ignored while a
+// push/pop animation is still running
+void settleAnimations()
+{
+    QElapsedTimer timer;
+    timer.start();
+    while (timer.elapsed() < 700) {
+        QApplication::processEvents(QEventLoop::AllEvents, 50);
+    }
+}
+
+void benchStackView(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<StackVisualizer> stack;
+    auto prefilled = [&](long long capacity) {
+        stack.reset(new StackVisualizer);
+        stack->resize(1024, 768);
+        stack->show();
+        stack->setCapacity(int(capacity));
+        stack->setHistoryEnabled(false);
+        for (long long i = 0; i < n; i++) {
+            stack->push(int(i));
+        }
+    };
+
+    runner.run("view.stack.push", n, n, [&] { prefilled(2 * n); },
+               [&](long long i) { stack->push(int(i)); });
+    runner.run("view.stack.pop", n, n, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(stack->pop()); });
+
+    const long long historyOps = std::min(n, 1000LL);
+    runner.run("view.stack.undo", n, historyOps,
+               [&] {
+                   prefilled(n + historyOps);
+                   stack->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) stack->push(int(i));
+                   settleAnimations();
+               },
+               [&](long long) { stack->undoOperation(); });
+    runner.run("view.stack.redo", n, historyOps,
+               [&] {
+                   prefilled(n + historyOps);
+                   stack->setHistoryEnabled(true);
+                   for (long long i = 0; i < historyOps; i++) stack->push(int(i));
+                   settleAnimations();
+                   for (long long i = 0; i < historyOps; i++) stack->undoOperation();
+               },
+               [&](long long) { stack->redoOperation(); });
+    stack.reset();
+}
+
+void benchQueueView(bench::Runner &runner, long long n)
+{
+    std::unique_ptr<QueueVisualizer> queue;
+    auto prefilled = [&](long long capacity) {
+        queue.reset(new QueueVisualizer);
+        queue->resize(1024, 768);
+        queue->show();
+        queue->setCapacity(int(capacity));
+        queue->setHistoryEnabled(false);
+        for (long long i = 0; i < n; i++) {
+            queue->enqueue(int(i));
+        }
+    };
+
+    runner.run("view.queue.enqueue", n, n, [&] { prefilled(2 * n); },
+               [&](long long i) { queue->enqueue(int(i)); });
+    runner.run("view.queue.dequeue", n, n, [&] { prefilled(n); },
+               [&](long long) { bench::doNotOptimize(queue->dequeue()); });
+    queue.reset();
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication app(argc, argv);
+
+    bench::Options options;
+    options.maxSize = 100000;
+    options.outputPath = "dsv_view_bench.csv";
+    if (!bench::parseOptions(argc, argv, options)) {
+        return 2;
+    }
+
+    bench::Runner runner(options);
+    for (long long n : bench::sizeSweep(options)) {
+        benchStackView(runner, n);
+        benchQueueView(runner, n);
+    }
+
+    return runner.writeCsv() ? 0 : 1;
+}
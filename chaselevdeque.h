@@ -0,0 +1,137 @@
+#ifndef CHASELEVDEQUE_H
+#define CHASELEVDEQUE_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+// Work-stealing deque (Chase & Lev, 2005, with the C11 orderings of
+// Le et al., 2013). The owner thread pushes and takes at the bottom like a
+// stack; any other thread may steal from the top. T must be trivially
+// copyable. Outgrown arrays are kept until the deque is destroyed, since a
+// thief may still be reading from one.
+template <typename T>
+class ChaseLevDeque
+{
+public:
+    enum StealResult { Stolen, Empty, Lost };
+
+    explicit ChaseLevDeque(std::size_t capacity = 64)
+        : top(0)
+        , bottom(0)
+    {
+        std::size_t size = 2;
+        while (size < capacity) size <<= 1;
+        arrays.emplace_back(new Array(size));
+        array.store(arrays.back().get(), std::memory_order_relaxed);
+    }
+
+    ChaseLevDeque(const ChaseLevDeque &) = delete;
+    ChaseLevDeque &operator=(const ChaseLevDeque &) = delete;
+
+    // Owner only
+    void push(const T &value)
+    {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed);
+        const std::int64_t t = top.load(std::memory_order_acquire);
+        Array *a = array.load(std::memory_order_relaxed);
+        if (b - t > std::int64_t(a->mask)) {
+            a = grow(a, t, b);
+        }
+        a->put(b, value);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+    }
+
+    // Owner only; false when the deque is empty
+    bool take(T &value)
+    {
+        const std::int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        Array *a = array.load(std::memory_order_relaxed);
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        std::int64_t t = top.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        value = a->get(b);
+        if (t == b) {
+            // Last element: race the thieves for it
+            const bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                                         std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Any thread
+    StealResult steal(T &value)
+    {
+        std::int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const std::int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return Empty;
+        }
+        Array *a = array.load(std::memory_order_acquire);
+        value = a->get(t);
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                         std::memory_order_relaxed)) {
+            return Lost;
+        }
+        return Stolen;
+    }
+
+    // Any thread; approximate while other threads are active
+    std::int64_t size() const
+    {
+        const std::int64_t t = top.load(std::memory_order_relaxed);
+        const std::int64_t b = bottom.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+private:
+    struct Array {
+        explicit Array(std::size_t size)
+            : mask(size - 1)
+            , slots(new std::atomic<T>[size])
+        {
+        }
+
+        T get(std::int64_t i) const
+        {
+            return slots[std::size_t(i) & mask].load(std::memory_order_relaxed);
+        }
+
+        void put(std::int64_t i, const T &value)
+        {
+            slots[std::size_t(i) & mask].store(value, std::memory_order_relaxed);
+        }
+
+        const std::size_t mask;
+        const std::unique_ptr<std::atomic<T>[]> slots;
+    };
+
+    alignas(64) std::atomic<std::int64_t> top;
+    alignas(64) std::atomic<std::int64_t> bottom;
+    std::atomic<Array *> array;
+    // Owner-only list of every array ever used
+    std::vector<std::unique_ptr<Array>> arrays;
+
+    Array *grow(Array *old, std::int64_t t, std::int64_t b)
+    {
+        arrays.emplace_back(new Array((old->mask + 1) * 2));
+        Array *bigger = arrays.back().get();
+        for (std::int64_t i = t; i < b; i++) {
+            bigger->put(i, old->get(i));
+        }
+        array.store(bigger, std::memory_order_release);
+        return bigger;
+    }
+};
+
+#endif // CHASELEVDEQUE_H
@@ -0,0 +1,283 @@
+#include "columnevaluator.h"
+#include "postfixevaluator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__))
+#define DSV_X86_KERNELS 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+void addScalar(const double *lhs, const double *rhs, double *out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) out[i] = lhs[i] + rhs[i];
+}
+
+void subScalar(const double *lhs, const double *rhs, double *out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) out[i] = lhs[i] - rhs[i];
+}
+
+void mulScalar(const double *lhs, const double *rhs, double *out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) out[i] = lhs[i] * rhs[i];
+}
+
+void divScalar(const double *lhs, const double *rhs, double *out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) out[i] = lhs[i] / rhs[i];
+}
+
+// pow has no vector instruction, so every kernel set shares this one
+void powScalar(const double *lhs, const double *rhs, double *out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) out[i] = std::pow(lhs[i], rhs[i]);
+}
+
+// Comparisons, logic, min/max and the functions only have scalar loops
+void binaryScalar(PostfixEvaluator::OpCode op, const double *lhs, const double *rhs, double *out, std::size_t n)
+{
+    for (std::size_t i = 0; i < n; i++) out[i] = PostfixEvaluator::applyBinary(op, lhs[i], rhs[i]);
+}
+
+void unaryScalar(PostfixEvaluator::OpCode op, const double *operand, double *out, std::size_t n)
+{
+    if (op == PostfixEvaluator::Neg) {
+        for (std::size_t i = 0; i < n; i++) out[i] = -operand[i];
+        return;
+    }
+    for (std::size_t i = 0; i < n; i++) out[i] = PostfixEvaluator::applyUnary(op, operand[i]);
+}
+
+#ifdef DSV_X86_KERNELS
+
+#define DSV_SSE2_KERNEL(name, intrinsic, op)                                     \
+    __attribute__((target("sse2")))                                              \
+    void name(const double *lhs, const double *rhs, double *out, std::size_t n)  \
+    {                                                                            \
+        std::size_t i = 0;                                                       \
+        for (; i + 2 <= n; i += 2) {                                             \
+            _mm_storeu_pd(out + i, intrinsic(_mm_loadu_pd(lhs + i),              \
+                                             _mm_loadu_pd(rhs + i)));            \
+        }                                                                        \
+        for (; i < n; i++) out[i] = lhs[i] op rhs[i];                            \
+    }
+
+#define DSV_AVX2_KERNEL(name, intrinsic, op)                                     \
+    __attribute__((target("avx2")))                                              \
+    void name(const double *lhs, const double *rhs, double *out, std::size_t n)  \
+    {                                                                            \
+        std::size_t i = 0;                                                       \
+        for (; i + 8 <= n; i += 8) {                                             \
+            __m256d a = intrinsic(_mm256_loadu_pd(lhs + i),                      \
+                                  _mm256_loadu_pd(rhs + i));                     \
+            __m256d b = intrinsic(_mm256_loadu_pd(lhs + i + 4),                  \
+                                  _mm256_loadu_pd(rhs + i + 4));                 \
+            _mm256_storeu_pd(out + i, a);                                        \
+            _mm256_storeu_pd(out + i + 4, b);                                    \
+        }                                                                        \
+        for (; i < n; i++) out[i] = lhs[i] op rhs[i];                            \
+    }
+
+DSV_SSE2_KERNEL(addSse2, _mm_add_pd, +)
+DSV_SSE2_KERNEL(subSse2, _mm_sub_pd, -)
+DSV_SSE2_KERNEL(mulSse2, _mm_mul_pd, *)
+DSV_SSE2_KERNEL(divSse2, _mm_div_pd, /)
+
+DSV_AVX2_KERNEL(addAvx2, _mm256_add_pd, +)
+DSV_AVX2_KERNEL(subAvx2, _mm256_sub_pd, -)
+DSV_AVX2_KERNEL(mulAvx2, _mm256_mul_pd, *)
+DSV_AVX2_KERNEL(divAvx2, _mm256_div_pd, /)
+
+#undef DSV_SSE2_KERNEL
+#undef DSV_AVX2_KERNEL
+
+#endif // DSV_X86_KERNELS
+
+} // namespace
+
+bool ColumnTable::load(const std::string &path, std::string *error)
+{
+    names.clear();
+    columns.clear();
+    rows = 0;
+
+    std::ifstream file(path);
+    if (!file) {
+        if (error) *error = "Cannot open " + path;
+        return false;
+    }
+
+    std::string line;
+    if (!std::getline(file, line)) {
+        if (error) *error = "File is empty";
+        return false;
+    }
+
+    std::stringstream header(line);
+    std::string name;
+    while (std::getline(header, name, ',')) {
+        name.erase(0, name.find_first_not_of(" \t\r"));
+        name.erase(name.find_last_not_of(" \t\r") + 1);
+        names.push_back(name);
+    }
+    columns.resize(names.size());
+
+    while (std::getline(file, line)) {
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        const char *p = line.c_str();
+        for (std::size_t c = 0; c < columns.size(); c++) {
+            char *end = nullptr;
+            const double value = std::strtod(p, &end);
+            if (end == p) {
+                if (error) *error = "Invalid number on data line " + std::to_string(rows + 1);
+                return false;
+            }
+            columns[c].push_back(value);
+            p = end;
+            while (*p == ' ' || *p == '\t') p++;
+            if (c + 1 < columns.size()) {
+                if (*p != ',') {
+                    if (error) *error = "Too few values on data line " + std::to_string(rows + 1);
+                    return false;
+                }
+                p++;
+            }
+        }
+        rows++;
+    }
+    return true;
+}
+
+int ColumnTable::columnIndex(const std::string &name) const
+{
+    auto it = std::find(names.begin(), names.end(), name);
+    return it == names.end() ? -1 : static_cast<int>(it - names.begin());
+}
+
+ColumnEvaluator::ColumnEvaluator(Isa isa)
+{
+    setIsa(isa);
+}
+
+ColumnEvaluator::Isa ColumnEvaluator::detectIsa()
+{
+#ifdef DSV_X86_KERNELS
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return AVX2;
+    if (__builtin_cpu_supports("sse2")) return SSE2;
+#endif
+    return Scalar;
+}
+
+const char *ColumnEvaluator::isaName(Isa isa)
+{
+    switch (isa) {
+        case AVX2: return "AVX2";
+        case SSE2: return "SSE2";
+        case Scalar: break;
+    }
+    return "Scalar";
+}
+
+ColumnEvaluator::Isa ColumnEvaluator::isa() const
+{
+    return currentIsa;
+}
+
+void ColumnEvaluator::setIsa(Isa isa)
+{
+    // Never select kernels the CPU cannot execute
+    if (isa > detectIsa()) isa = detectIsa();
+    currentIsa = isa;
+
+    add = addScalar;
+    sub = subScalar;
+    mul = mulScalar;
+    div = divScalar;
+#ifdef DSV_X86_KERNELS
+    if (isa == SSE2) {
+        add = addSse2;
+        sub = subSse2;
+        mul = mulSse2;
+        div = divSse2;
+    } else if (isa == AVX2) {
+        add = addAvx2;
+        sub = subAvx2;
+        mul = mulAvx2;
+        div = divAvx2;
+    }
+#endif
+}
+
+void ColumnEvaluator::evaluate(const PostfixEvaluator &program, const double *const *columns,
+                               std::size_t rows, double *out)
+{
+    const std::vector<PostfixEvaluator::Instruction> &code = program.program();
+    const std::vector<double> &constants = program.constants();
+
+    // One BLOCK_ROWS buffer per stack slot. A slot that holds an untouched
+    // column points straight into that column instead of copying it.
+    std::size_t slots = 0;
+    std::size_t depth = 0;
+    for (const PostfixEvaluator::Instruction &ins : code) {
+        depth = depth + 1 - PostfixEvaluator::arity(ins.op);
+        slots = std::max(slots, depth);
+    }
+    if (scratch.size() < slots * BLOCK_ROWS) {
+        scratch.resize(slots * BLOCK_ROWS);
+    }
+    if (stack.size() < slots) {
+        stack.resize(slots);
+    }
+
+    for (std::size_t begin = 0; begin < rows; begin += BLOCK_ROWS) {
+        const std::size_t n = std::min(BLOCK_ROWS, rows - begin);
+        std::size_t sp = 0;
+        for (const PostfixEvaluator::Instruction &ins : code) {
+            if (ins.op == PostfixEvaluator::PushConst) {
+                double *slot = scratch.data() + sp * BLOCK_ROWS;
+                std::fill(slot, slot + n, constants[ins.operand]);
+                stack[sp++] = slot;
+                continue;
+            }
+            if (ins.op == PostfixEvaluator::PushVar) {
+                stack[sp++] = columns[ins.operand] + begin;
+                continue;
+            }
+
+            if (PostfixEvaluator::arity(ins.op) == 1) {
+                double *slot = scratch.data() + (sp - 1) * BLOCK_ROWS;
+                unaryScalar(ins.op, stack[sp - 1], slot, n);
+                stack[sp - 1] = slot;
+                continue;
+            }
+
+            Kernel kernel = nullptr;
+            switch (ins.op) {
+                case PostfixEvaluator::Add: kernel = add; break;
+                case PostfixEvaluator::Sub: kernel = sub; break;
+                case PostfixEvaluator::Mul: kernel = mul; break;
+                case PostfixEvaluator::Div: kernel = div; break;
+                case PostfixEvaluator::Pow: kernel = powScalar; break;
+                default: break;
+            }
+            double *slot = scratch.data() + (sp - 2) * BLOCK_ROWS;
+            if (kernel) {
+                kernel(stack[sp - 2], stack[sp - 1], slot, n);
+            } else {
+                binaryScalar(ins.op, stack[sp - 2], stack[sp - 1], slot, n);
+            }
+            sp--;
+            stack[sp - 1] = slot;
+        }
+        std::copy(stack[0], stack[0] + n, out + begin);
+    }
+}
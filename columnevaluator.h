@@ -0,0 +1,57 @@
+#ifndef COLUMNEVALUATOR_H
+#define COLUMNEVALUATOR_H
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+class PostfixEvaluator;
+
+// Numeric columns loaded from a CSV file whose first line names the columns.
+struct ColumnTable
+{
+    std::vector<std::string> names;
+    std::vector<std::vector<double>> columns;
+    std::size_t rows = 0;
+
+    bool load(const std::string &path, std::string *error = nullptr);
+    int columnIndex(const std::string &name) const;
+};
+
+// Evaluates a compiled postfix program over whole columns of variable
+// values. Each instruction runs as a kernel over a block of rows instead of
+// evaluating the program once per row. The kernel set (AVX2, SSE2 or scalar)
+// is picked at runtime from what the CPU supports.
+class ColumnEvaluator
+{
+public:
+    enum Isa { Scalar, SSE2, AVX2 };
+
+    // Rows per block; keeps the working set of one block in L1/L2
+    static constexpr std::size_t BLOCK_ROWS = 2048;
+
+    explicit ColumnEvaluator(Isa isa = detectIsa());
+
+    static Isa detectIsa();
+    static const char *isaName(Isa isa);
+
+    Isa isa() const;
+    void setIsa(Isa isa);
+
+    // columns is indexed like program.variables(); out must hold rows values
+    void evaluate(const PostfixEvaluator &program, const double *const *columns,
+                  std::size_t rows, double *out);
+
+private:
+    typedef void (*Kernel)(const double *lhs, const double *rhs, double *out, std::size_t n);
+
+    Isa currentIsa;
+    Kernel add;
+    Kernel sub;
+    Kernel mul;
+    Kernel div;
+    std::vector<double> scratch;
+    std::vector<const double *> stack;
+};
+
+#endif // COLUMNEVALUATOR_H
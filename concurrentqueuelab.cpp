@@ -0,0 +1,222 @@
+#include "concurrentqueuelab.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGroupBox>
+#include <QHeaderView>
+#include <QLabel>
+#include <QLocale>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTableWidget>
+#include <utility>
+#include <vector>
+
+ConcurrentQueueLab::ConcurrentQueueLab(QWidget *parent)
+    : QWidget(parent)
+    , cancelRequested(false)
+{
+    setupUI();
+
+    connect(runButton, &QPushButton::clicked, this, [this]() { startRuns(false); });
+    connect(sweepButton, &QPushButton::clicked, this, [this]() { startRuns(true); });
+    connect(cancelButton, &QPushButton::clicked, this, [this]() {
+        cancelRequested.store(true);
+        statusLabel->setText("Cancelling...");
+    });
+}
+
+ConcurrentQueueLab::~ConcurrentQueueLab()
+{
+    cancelRequested.store(true);
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+void ConcurrentQueueLab::setupUI()
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    const int cores = qMax(1, int(std::thread::hardware_concurrency()));
+
+    // Create configuration group
+    QGroupBox *configGroup = new QGroupBox("Configuration");
+    QHBoxLayout *configLayout = new QHBoxLayout;
+
+    producersSpinBox = new QSpinBox;
+    producersSpinBox->setPrefix("Producers: ");
+    producersSpinBox->setRange(1, 256);
+    producersSpinBox->setValue(qMax(1, cores / 2));
+
+    consumersSpinBox = new QSpinBox;
+    consumersSpinBox->setPrefix("Consumers: ");
+    consumersSpinBox->setRange(1, 256);
+    consumersSpinBox->setValue(qMax(1, cores / 2));
+
+    itemsSpinBox = new QSpinBox;
+    itemsSpinBox->setPrefix("Items per producer: ");
+    itemsSpinBox->setRange(1000, 100000000);
+    itemsSpinBox->setSingleStep(100000);
+    itemsSpinBox->setValue(200000);
+
+    capacitySpinBox = new QSpinBox;
+    capacitySpinBox->setPrefix("Capacity: ");
+    capacitySpinBox->setRange(2, 1 << 24);
+    capacitySpinBox->setValue(1024);
+    capacitySpinBox->setToolTip("Slots of the bounded queues; the Michael-Scott queue is unbounded");
+
+    configLayout->addWidget(producersSpinBox);
+    configLayout->addWidget(consumersSpinBox);
+    configLayout->addWidget(itemsSpinBox);
+    configLayout->addWidget(capacitySpinBox);
+    configGroup->setLayout(configLayout);
+    mainLayout->addWidget(configGroup);
+
+    // Create controls group
+    QGroupBox *controlsGroup = new QGroupBox("Controls");
+    QHBoxLayout *controlsLayout = new QHBoxLayout;
+    runButton = new QPushButton("Run");
+    runButton->setToolTip("Run every implementation once with the configured thread counts");
+    sweepButton = new QPushButton("Scaling Sweep");
+    sweepButton->setToolTip("Run 1, 2, 4, ... threads per side up to the configured counts");
+    cancelButton = new QPushButton("Cancel");
+    cancelButton->setEnabled(false);
+    QLabel *coresLabel = new QLabel(QString("Hardware threads: %1").arg(cores));
+    controlsLayout->addWidget(runButton);
+    controlsLayout->addWidget(sweepButton);
+    controlsLayout->addWidget(cancelButton);
+    controlsLayout->addStretch();
+    controlsLayout->addWidget(coresLabel);
+    controlsGroup->setLayout(controlsLayout);
+    mainLayout->addWidget(controlsGroup);
+
+    // Create results group
+    QGroupBox *resultsGroup = new QGroupBox("Results");
+    QVBoxLayout *resultsLayout = new QVBoxLayout;
+    resultsTable = new QTableWidget(0, 8);
+    resultsTable->setHorizontalHeaderLabels({"Implementation", "Producers", "Consumers", "Items/s",
+                                             "p50 enqueue", "p99 enqueue", "Contention", "Lost/Dup"});
+    resultsTable->horizontalHeader()->setSectionResizeMode(QHeaderView::Stretch);
+    resultsTable->verticalHeader()->setVisible(false);
+    resultsTable->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    resultsTable->setSelectionBehavior(QAbstractItemView::SelectRows);
+    resultsLayout->addWidget(resultsTable);
+    resultsGroup->setLayout(resultsLayout);
+    mainLayout->addWidget(resultsGroup);
+
+    // Create status group
+    QGroupBox *statusGroup = new QGroupBox("Status");
+    QVBoxLayout *statusLayout = new QVBoxLayout;
+    statusLabel = new QLabel("Ready");
+    statusLayout->addWidget(statusLabel);
+    statusGroup->setLayout(statusLayout);
+    mainLayout->addWidget(statusGroup);
+
+    setLayout(mainLayout);
+}
+
+void ConcurrentQueueLab::startRuns(bool sweep)
+{
+    if (worker.joinable()) {
+        worker.join();
+    }
+
+    const int producers = producersSpinBox->value();
+    const int consumers = consumersSpinBox->value();
+    const std::uint64_t items = std::uint64_t(itemsSpinBox->value());
+    const std::size_t capacity = std::size_t(capacitySpinBox->value());
+
+    // Thread counts double per step; each side stops at its configured count
+    std::vector<std::pair<int, int>> counts;
+    if (sweep) {
+        for (int n = 1;; n *= 2) {
+            counts.emplace_back(qMin(n, producers), qMin(n, consumers));
+            if (n >= producers && n >= consumers) break;
+        }
+    } else {
+        counts.emplace_back(producers, consumers);
+    }
+
+    resultsTable->setRowCount(0);
+    cancelRequested.store(false);
+    setRunning(true);
+    statusLabel->setText("Running...");
+
+    worker = std::thread([this, counts, items, capacity]() {
+        const ConcurrentQueue::Kind kinds[] = {
+            ConcurrentQueue::MutexRing, ConcurrentQueue::MichaelScott, ConcurrentQueue::BoundedMpmc
+        };
+        bool cancelled = false;
+        for (const std::pair<int, int> &count : counts) {
+            for (ConcurrentQueue::Kind kind : kinds) {
+                if (cancelRequested.load()) {
+                    cancelled = true;
+                    break;
+                }
+                const QueueLabResult result =
+                    runQueueLab(kind, count.first, count.second, items, capacity, &cancelRequested);
+                if (result.cancelled) {
+                    cancelled = true;
+                    break;
+                }
+                QMetaObject::invokeMethod(this, [this, result]() { addResult(result); }, Qt::QueuedConnection);
+            }
+            if (cancelled) break;
+        }
+        QMetaObject::invokeMethod(this, [this, cancelled]() { runsFinished(cancelled); }, Qt::QueuedConnection);
+    });
+}
+
+void ConcurrentQueueLab::addResult(const QueueLabResult &result)
+{
+    QLocale locale;
+    const QStringList cells = {
+        ConcurrentQueue::kindName(result.kind),
+        QString::number(result.producers),
+        QString::number(result.consumers),
+        locale.toString(result.itemsPerSecond, 'f', 0),
+        QString("%1 ns").arg(result.p50EnqueueNs, 0, 'f', 0),
+        QString("%1 ns").arg(result.p99EnqueueNs, 0, 'f', 0),
+        locale.toString(qulonglong(result.contention)),
+        QString::number(result.itemErrors),
+    };
+
+    const int row = resultsTable->rowCount();
+    resultsTable->insertRow(row);
+    for (int column = 0; column < cells.size(); column++) {
+        QTableWidgetItem *item = new QTableWidgetItem(cells[column]);
+        if (column > 0) {
+            item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+        }
+        if (column == cells.size() - 1 && result.itemErrors != 0) {
+            item->setForeground(Qt::red);
+        }
+        resultsTable->setItem(row, column, item);
+    }
+    resultsTable->scrollToBottom();
+    statusLabel->setText(QString("Finished %1 with %2 producers / %3 consumers in %4 s")
+                             .arg(ConcurrentQueue::kindName(result.kind))
+                             .arg(result.producers)
+                             .arg(result.consumers)
+                             .arg(result.seconds, 0, 'f', 2));
+}
+
+void ConcurrentQueueLab::runsFinished(bool cancelled)
+{
+    if (worker.joinable()) {
+        worker.join();
+    }
+    setRunning(false);
+    statusLabel->setText(cancelled ? "Cancelled" : QString("Done - %1 runs").arg(resultsTable->rowCount()));
+}
+
+void ConcurrentQueueLab::setRunning(bool running)
+{
+    runButton->setEnabled(!running);
+    sweepButton->setEnabled(!running);
+    cancelButton->setEnabled(running);
+    producersSpinBox->setEnabled(!running);
+    consumersSpinBox->setEnabled(!running);
+    itemsSpinBox->setEnabled(!running);
+    capacitySpinBox->setEnabled(!running);
+}
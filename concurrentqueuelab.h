@@ -0,0 +1,46 @@
+#ifndef CONCURRENTQUEUELAB_H
+#define CONCURRENTQUEUELAB_H
+
+#include <QWidget>
+#include <atomic>
+#include <thread>
+#include "concurrentqueues.h"
+
+class QPushButton;
+class QSpinBox;
+class QLabel;
+class QTableWidget;
+
+// Runs N producers and M consumers against each ConcurrentQueue
+// implementation and tabulates throughput, enqueue latency and contention.
+// Runs happen on a worker thread; results are posted back one row at a time.
+class ConcurrentQueueLab : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit ConcurrentQueueLab(QWidget *parent = nullptr);
+    ~ConcurrentQueueLab();
+
+private:
+    QSpinBox *producersSpinBox;
+    QSpinBox *consumersSpinBox;
+    QSpinBox *itemsSpinBox;
+    QSpinBox *capacitySpinBox;
+    QPushButton *runButton;
+    QPushButton *sweepButton;
+    QPushButton *cancelButton;
+    QTableWidget *resultsTable;
+    QLabel *statusLabel;
+
+    std::thread worker;
+    std::atomic<bool> cancelRequested;
+
+    void setupUI();
+    void startRuns(bool sweep);
+    void addResult(const QueueLabResult &result);
+    void runsFinished(bool cancelled);
+    void setRunning(bool running);
+};
+
+#endif // CONCURRENTQUEUELAB_H
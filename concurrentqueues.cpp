@@ -0,0 +1,342 @@
+#include "concurrentqueues.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <thread>
+
+namespace {
+// Every n-th enqueue is timed, which keeps clock reads off the hot path
+const std::uint64_t LATENCY_SAMPLE_EVERY = 8;
+// Items between polls of the cancel flag
+const std::uint64_t CANCEL_CHECK_EVERY = 1024;
+}
+
+std::unique_ptr<ConcurrentQueue> ConcurrentQueue::create(Kind kind, std::size_t capacity)
+{
+    switch (kind) {
+        case MutexRing: return std::unique_ptr<ConcurrentQueue>(new MutexRingQueue(capacity));
+        case MichaelScott: return std::unique_ptr<ConcurrentQueue>(new MichaelScottQueue);
+        case BoundedMpmc: return std::unique_ptr<ConcurrentQueue>(new BoundedMpmcQueue(capacity));
+    }
+    return nullptr;
+}
+
+const char *ConcurrentQueue::kindName(Kind kind)
+{
+    switch (kind) {
+        case MutexRing: return "Mutex ring";
+        case MichaelScott: return "Michael-Scott";
+        case BoundedMpmc: return "Bounded MPMC";
+    }
+    return "";
+}
+
+MutexRingQueue::MutexRingQueue(std::size_t capacity)
+    : ring(static_cast<int>(std::min<std::size_t>(capacity, QueueEngine::MAX_CAPACITY)))
+    , waits(0)
+{
+    ring.setHistoryEnabled(false);
+}
+
+void MutexRingQueue::lock()
+{
+    if (!mutex.try_lock()) {
+        waits.fetch_add(1, std::memory_order_relaxed);
+        mutex.lock();
+    }
+}
+
+bool MutexRingQueue::tryEnqueue(int value)
+{
+    lock();
+    const bool ok = !ring.isFull() && ring.enqueue(value);
+    mutex.unlock();
+    return ok;
+}
+
+bool MutexRingQueue::tryDequeue(int &value)
+{
+    lock();
+    const bool ok = !ring.isEmpty();
+    if (ok) {
+        value = ring.dequeue();
+    }
+    mutex.unlock();
+    return ok;
+}
+
+std::uint64_t MutexRingQueue::contention() const
+{
+    return waits.load(std::memory_order_relaxed);
+}
+
+MichaelScottQueue::MichaelScottQueue()
+    : casFailures(0)
+{
+    Node *dummy = new Node{{nullptr}, 0};
+    first = dummy;
+    head.store(dummy, std::memory_order_relaxed);
+    tail.store(dummy, std::memory_order_relaxed);
+}
+
+MichaelScottQueue::~MichaelScottQueue()
+{
+    // Dequeued nodes stay linked ahead of head, so one walk frees them all
+    Node *node = first;
+    while (node) {
+        Node *next = node->next.load(std::memory_order_relaxed);
+        delete node;
+        node = next;
+    }
+}
+
+bool MichaelScottQueue::tryEnqueue(int value)
+{
+    Node *node = new Node{{nullptr}, value};
+    for (;;) {
+        Node *last = tail.load(std::memory_order_acquire);
+        Node *next = last->next.load(std::memory_order_acquire);
+        if (last == tail.load(std::memory_order_acquire)) {
+            if (!next) {
+                if (last->next.compare_exchange_weak(next, node, std::memory_order_release,
+                                                     std::memory_order_relaxed)) {
+                    tail.compare_exchange_strong(last, node, std::memory_order_release,
+                                                 std::memory_order_relaxed);
+                    return true;
+                }
+            } else {
+                // Tail is lagging; help the other producer swing it
+                tail.compare_exchange_strong(last, next, std::memory_order_release,
+                                             std::memory_order_relaxed);
+            }
+        }
+        casFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+bool MichaelScottQueue::tryDequeue(int &value)
+{
+    for (;;) {
+        Node *front = head.load(std::memory_order_acquire);
+        Node *last = tail.load(std::memory_order_acquire);
+        Node *next = front->next.load(std::memory_order_acquire);
+        if (front == head.load(std::memory_order_acquire)) {
+            if (front == last) {
+                if (!next) {
+                    return false;
+                }
+                tail.compare_exchange_strong(last, next, std::memory_order_release,
+                                             std::memory_order_relaxed);
+            } else {
+                // Nodes are never freed while the queue lives, so reading
+                // next->value before the CAS is safe
+                const int result = next->value;
+                if (head.compare_exchange_weak(front, next, std::memory_order_acq_rel,
+                                               std::memory_order_relaxed)) {
+                    value = result;
+                    return true;
+                }
+            }
+        }
+        casFailures.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+std::uint64_t MichaelScottQueue::contention() const
+{
+    return casFailures.load(std::memory_order_relaxed);
+}
+
+BoundedMpmcQueue::BoundedMpmcQueue(std::size_t capacity)
+    : enqueuePos(0)
+    , dequeuePos(0)
+    , casFailures(0)
+{
+    std::size_t size = 2;
+    while (size < capacity) size <<= 1;
+    mask = size - 1;
+    cells.reset(new Cell[size]);
+    for (std::size_t i = 0; i < size; i++) {
+        cells[i].sequence.store(i, std::memory_order_relaxed);
+    }
+}
+
+bool BoundedMpmcQueue::tryEnqueue(int value)
+{
+    std::size_t pos = enqueuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+        cell = &cells[pos & mask];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = std::intptr_t(sequence) - std::intptr_t(pos);
+        if (diff == 0) {
+            if (enqueuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+            casFailures.fetch_add(1, std::memory_order_relaxed);
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = enqueuePos.load(std::memory_order_relaxed);
+        }
+    }
+    cell->value = value;
+    cell->sequence.store(pos + 1, std::memory_order_release);
+    return true;
+}
+
+bool BoundedMpmcQueue::tryDequeue(int &value)
+{
+    std::size_t pos = dequeuePos.load(std::memory_order_relaxed);
+    Cell *cell;
+    for (;;) {
+        cell = &cells[pos & mask];
+        const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+        const std::intptr_t diff = std::intptr_t(sequence) - std::intptr_t(pos + 1);
+        if (diff == 0) {
+            if (dequeuePos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                break;
+            }
+            casFailures.fetch_add(1, std::memory_order_relaxed);
+        } else if (diff < 0) {
+            return false;
+        } else {
+            pos = dequeuePos.load(std::memory_order_relaxed);
+        }
+    }
+    value = cell->value;
+    cell->sequence.store(pos + mask + 1, std::memory_order_release);
+    return true;
+}
+
+std::uint64_t BoundedMpmcQueue::contention() const
+{
+    return casFailures.load(std::memory_order_relaxed);
+}
+
+QueueLabResult runQueueLab(ConcurrentQueue::Kind kind, int producers, int consumers,
+                           std::uint64_t itemsPerProducer, std::size_t capacity,
+                           const std::atomic<bool> *cancel)
+{
+    typedef std::chrono::steady_clock Clock;
+    const auto isCancelled = [cancel] { return cancel && cancel->load(std::memory_order_relaxed); };
+
+    std::unique_ptr<ConcurrentQueue> queue = ConcurrentQueue::create(kind, capacity);
+    std::atomic<bool> go(false);
+    std::atomic<int> producersDone(0);
+    std::vector<std::vector<std::uint32_t>> latencies(producers);
+    std::vector<std::uint64_t> consumed(consumers, 0);
+    std::vector<std::uint64_t> checksums(consumers, 0);
+
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&, p] {
+            std::vector<std::uint32_t> &samples = latencies[p];
+            samples.reserve(itemsPerProducer / LATENCY_SAMPLE_EVERY + 1);
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            // False when cancelled while the queue was full
+            const auto enqueue = [&](int value) {
+                while (!queue->tryEnqueue(value)) {
+                    if (isCancelled()) return false;
+                    std::this_thread::yield();
+                }
+                return true;
+            };
+            for (std::uint64_t i = 0; i < itemsPerProducer; i++) {
+                if (i % CANCEL_CHECK_EVERY == 0 && isCancelled()) break;
+                const int value = static_cast<int>(i & 0x7fffffff);
+                if (i % LATENCY_SAMPLE_EVERY == 0) {
+                    const Clock::time_point start = Clock::now();
+                    if (!enqueue(value)) break;
+                    const long long ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count();
+                    samples.push_back(static_cast<std::uint32_t>(std::min<long long>(ns, UINT32_MAX)));
+                } else if (!enqueue(value)) {
+                    break;
+                }
+            }
+            producersDone.fetch_add(1, std::memory_order_release);
+        });
+    }
+    for (int c = 0; c < consumers; c++) {
+        threads.emplace_back([&, c] {
+            std::uint64_t count = 0;
+            std::uint64_t sum = 0;
+            int value = 0;
+            while (!go.load(std::memory_order_acquire)) std::this_thread::yield();
+
+            for (;;) {
+                if (queue->tryDequeue(value)) {
+                    count++;
+                    sum += static_cast<std::uint64_t>(value);
+                    if (count % CANCEL_CHECK_EVERY == 0 && isCancelled()) break;
+                } else if (isCancelled()) {
+                    break;
+                } else if (producersDone.load(std::memory_order_acquire) == producers) {
+                    // Producers have finished; one more pass drains what is left
+                    if (!queue->tryDequeue(value)) break;
+                    count++;
+                    sum += static_cast<std::uint64_t>(value);
+                } else {
+                    std::this_thread::yield();
+                }
+            }
+            consumed[c] = count;
+            checksums[c] = sum;
+        });
+    }
+
+    const Clock::time_point start = Clock::now();
+    go.store(true, std::memory_order_release);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    const double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    QueueLabResult result;
+    result.kind = kind;
+    result.producers = producers;
+    result.consumers = consumers;
+    result.items = itemsPerProducer * std::uint64_t(producers);
+    result.seconds = seconds;
+    result.itemsPerSecond = seconds > 0 ? result.items / seconds : 0.0;
+    result.contention = queue->contention();
+    result.cancelled = isCancelled();
+    result.itemErrors = 0;
+    result.p50EnqueueNs = 0.0;
+    result.p99EnqueueNs = 0.0;
+    if (result.cancelled) {
+        return result;
+    }
+
+    std::uint64_t totalConsumed = 0;
+    std::uint64_t totalChecksum = 0;
+    for (int c = 0; c < consumers; c++) {
+        totalConsumed += consumed[c];
+        totalChecksum += checksums[c];
+    }
+    std::uint64_t expectedChecksum = 0;
+    for (std::uint64_t i = 0; i < itemsPerProducer; i++) {
+        expectedChecksum += (i & 0x7fffffff) * std::uint64_t(producers);
+    }
+    result.itemErrors = std::int64_t(totalConsumed) - std::int64_t(result.items);
+    if (result.itemErrors == 0 && totalChecksum != expectedChecksum) {
+        // Same count but different values: something was both lost and duplicated
+        result.itemErrors = -1;
+    }
+
+    std::vector<std::uint32_t> samples;
+    for (const std::vector<std::uint32_t> &producerSamples : latencies) {
+        samples.insert(samples.end(), producerSamples.begin(), producerSamples.end());
+    }
+    if (!samples.empty()) {
+        std::vector<std::uint32_t>::iterator p50 = samples.begin() + samples.size() / 2;
+        std::nth_element(samples.begin(), p50, samples.end());
+        result.p50EnqueueNs = *p50;
+        std::vector<std::uint32_t>::iterator p99 = samples.begin() + std::min(samples.size() - 1, samples.size() * 99 / 100);
+        std::nth_element(samples.begin(), p99, samples.end());
+        result.p99EnqueueNs = *p99;
+    }
+    return result;
+}
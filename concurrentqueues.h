@@ -0,0 +1,129 @@
+#ifndef CONCURRENTQUEUES_H
+#define CONCURRENTQUEUES_H
+
+#include "queueengine.h"
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// Interchangeable multi-producer/multi-consumer queues compared by the
+// queue lab. Every implementation counts contention: how often a thread had
+// to wait on or retry against another thread.
+class ConcurrentQueue
+{
+public:
+    enum Kind { MutexRing, MichaelScott, BoundedMpmc };
+
+    virtual ~ConcurrentQueue() {}
+
+    virtual bool tryEnqueue(int value) = 0;
+    virtual bool tryDequeue(int &value) = 0;
+    virtual std::uint64_t contention() const = 0;
+
+    static std::unique_ptr<ConcurrentQueue> create(Kind kind, std::size_t capacity);
+    static const char *kindName(Kind kind);
+};
+
+// The visualizer's QueueEngine ring behind one mutex. Contention counts
+// failed try_lock attempts.
+class MutexRingQueue : public ConcurrentQueue
+{
+public:
+    explicit MutexRingQueue(std::size_t capacity);
+
+    bool tryEnqueue(int value) override;
+    bool tryDequeue(int &value) override;
+    std::uint64_t contention() const override;
+
+private:
+    std::mutex mutex;
+    QueueEngine ring;
+    std::atomic<std::uint64_t> waits;
+
+    void lock();
+};
+
+// Unbounded lock-free linked queue (Michael & Scott, 1996). Dequeued nodes
+// are not freed until the queue is destroyed, which rules out ABA and
+// use-after-free without hazard pointers. Contention counts failed CAS
+// attempts.
+class MichaelScottQueue : public ConcurrentQueue
+{
+public:
+    MichaelScottQueue();
+    ~MichaelScottQueue() override;
+
+    bool tryEnqueue(int value) override;
+    bool tryDequeue(int &value) override;
+    std::uint64_t contention() const override;
+
+private:
+    struct Node {
+        std::atomic<Node *> next;
+        int value;
+    };
+
+    // Original dummy node; dequeued nodes stay reachable from it
+    Node *first;
+    alignas(64) std::atomic<Node *> head;
+    alignas(64) std::atomic<Node *> tail;
+    alignas(64) std::atomic<std::uint64_t> casFailures;
+};
+
+// Bounded array queue with a sequence number per cell (Vyukov). Producers
+// and consumers claim cells by CAS on separate cache-line padded counters.
+// Contention counts failed CAS attempts.
+class BoundedMpmcQueue : public ConcurrentQueue
+{
+public:
+    // capacity is rounded up to a power of two
+    explicit BoundedMpmcQueue(std::size_t capacity);
+
+    bool tryEnqueue(int value) override;
+    bool tryDequeue(int &value) override;
+    std::uint64_t contention() const override;
+
+private:
+    struct Cell {
+        std::atomic<std::size_t> sequence;
+        int value;
+    };
+
+    std::unique_ptr<Cell[]> cells;
+    std::size_t mask;
+    alignas(64) std::atomic<std::size_t> enqueuePos;
+    alignas(64) std::atomic<std::size_t> dequeuePos;
+    alignas(64) std::atomic<std::uint64_t> casFailures;
+};
+
+// One measured run of producers and consumers against a queue.
+struct QueueLabResult
+{
+    ConcurrentQueue::Kind kind;
+    int producers;
+    int consumers;
+    std::uint64_t items;
+    double seconds;
+    double itemsPerSecond;
+    // Per-call enqueue latency, including retries while the queue is full
+    double p50EnqueueNs;
+    double p99EnqueueNs;
+    std::uint64_t contention;
+    // Items that were lost or duplicated; must be zero
+    std::int64_t itemErrors;
+    // Stopped early through cancel; the other figures are meaningless
+    bool cancelled;
+};
+
+// Each producer enqueues itemsPerProducer values; consumers drain until all
+// producers are done and the queue is empty. Every thread polls cancel, when
+// given, and stops within a few thousand items of it being set.
+QueueLabResult runQueueLab(ConcurrentQueue::Kind kind, int producers, int consumers,
+                           std::uint64_t itemsPerProducer, std::size_t capacity,
+                           const std::atomic<bool> *cancel = nullptr);
+
+#endif // CONCURRENTQUEUES_H
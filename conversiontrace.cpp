@@ -0,0 +1,135 @@
+#include "conversiontrace.h"
+#include <algorithm>
+
+ConversionTrace::ConversionTrace()
+{
+    clear();
+}
+
+void ConversionTrace::record(const std::string &infix)
+{
+    clear();
+    this->infix = infix;
+
+    ShuntingYard converter;
+    converter.reset(infix);
+    tokenList = converter.tokens();
+    deltas.reserve(tokenList.size() + 1);
+    std::uint32_t outputTokens = 0;
+    std::size_t sinceSnapshot = 0;
+    while (!converter.isFinished()) {
+        const std::size_t before = converter.operatorStack().size();
+        const ShuntingYard::Step step = converter.step();
+        const std::vector<Token> &stack = converter.operatorStack();
+        const std::string &output = converter.output();
+
+        // Output tokens are separated by single spaces
+        const std::size_t previousLength = deltas.empty() ? 0 : deltas.back().outputLength;
+        if (output.size() > previousLength) {
+            outputTokens += std::uint32_t(previousLength == 0) +
+                            std::uint32_t(std::count(output.begin() + previousLength, output.end(), ' '));
+        }
+
+        Delta delta;
+        delta.token = step.token;
+        delta.outputLength = std::uint32_t(output.size());
+        delta.outputTokens = outputTokens;
+        delta.action = std::uint8_t(step.action);
+        delta.unmatchedParen = step.unmatchedParen;
+        delta.pushes = step.action == ShuntingYard::Step::Operator || step.action == ShuntingYard::Step::OpenParen ||
+                       step.action == ShuntingYard::Step::Function;
+        delta.pops = std::uint32_t(before + (delta.pushes ? 1 : 0) - stack.size());
+        deltas.push_back(delta);
+
+        // Snapshots are spaced by at least the stack depth, so copying them
+        // costs O(1) amortized per step
+        if (++sinceSnapshot >= std::max<std::size_t>(MIN_SNAPSHOT_INTERVAL, stack.size())) {
+            snapshots.push_back(Snapshot{int(deltas.size()), snapshotData.size(),
+                                         snapshotData.size() + stack.size()});
+            snapshotData.insert(snapshotData.end(), stack.begin(), stack.end());
+            sinceSnapshot = 0;
+        }
+    }
+    postfix = converter.output();
+}
+
+void ConversionTrace::clear()
+{
+    infix.clear();
+    tokenList.clear();
+    postfix.clear();
+    deltas.clear();
+    snapshots.clear();
+    snapshotData.clear();
+    // State 0 always starts from an empty stack
+    snapshots.push_back(Snapshot{0, 0, 0});
+}
+
+int ConversionTrace::stepCount() const
+{
+    return int(deltas.size());
+}
+
+const std::string &ConversionTrace::input() const
+{
+    return infix;
+}
+
+const std::vector<Token> &ConversionTrace::tokens() const
+{
+    return tokenList;
+}
+
+const std::string &ConversionTrace::output() const
+{
+    return postfix;
+}
+
+ShuntingYard::Step ConversionTrace::step(int index) const
+{
+    const Delta &delta = deltas[index];
+    return ShuntingYard::Step{ShuntingYard::Step::Action(delta.action), delta.token, delta.unmatchedParen};
+}
+
+int ConversionTrace::position(int state) const
+{
+    // Every step but the final one consumes one token
+    return std::min(state, int(tokenList.size()));
+}
+
+int ConversionTrace::outputLength(int state) const
+{
+    return state > 0 ? int(deltas[state - 1].outputLength) : 0;
+}
+
+int ConversionTrace::outputTokenCount(int state) const
+{
+    return state > 0 ? int(deltas[state - 1].outputTokens) : 0;
+}
+
+void ConversionTrace::operatorStack(int state, std::vector<Token> &stack) const
+{
+    const auto after = std::upper_bound(snapshots.begin(), snapshots.end(), state,
+                                        [](int s, const Snapshot &snapshot) { return s < snapshot.state; });
+    const Snapshot &snapshot = *(after - 1);
+    stack.assign(snapshotData.begin() + snapshot.begin, snapshotData.begin() + snapshot.end);
+    for (int i = snapshot.state; i < state; i++) {
+        const Delta &delta = deltas[i];
+        stack.resize(stack.size() - delta.pops);
+        if (delta.pushes) {
+            stack.push_back(delta.token);
+        }
+    }
+}
+
+bool ConversionTrace::isFinished(int state) const
+{
+    return state >= stepCount() && stepCount() > 0;
+}
+
+std::size_t ConversionTrace::memoryBytes() const
+{
+    return infix.capacity() + tokenList.capacity() * sizeof(Token) + postfix.capacity() +
+           deltas.capacity() * sizeof(Delta) + snapshots.capacity() * sizeof(Snapshot) +
+           snapshotData.capacity() * sizeof(Token);
+}
@@ -0,0 +1,74 @@
+#ifndef CONVERSIONTRACE_H
+#define CONVERSIONTRACE_H
+
+#include "shuntingyard.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// A whole infix to postfix conversion run once up front, so the state after
+// any step can be shown without re-running it. Each step is stored as a
+// delta: the output only grows, so a step needs just the output length it
+// leaves, and the operator stack changes by some pops and at most one push
+// of the step's own token. Periodic snapshots of the stack bound the deltas
+// replayed by a seek.
+//
+// States are numbered 0..stepCount(): state 0 is before the first step and
+// state k is right after step k - 1.
+class ConversionTrace
+{
+public:
+    static constexpr int MIN_SNAPSHOT_INTERVAL = 256;
+
+    ConversionTrace();
+
+    void record(const std::string &infix);
+    void clear();
+
+    int stepCount() const;
+    const std::string &input() const;
+    const std::vector<Token> &tokens() const;
+    // Output of the finished conversion; every state shows a prefix of it
+    const std::string &output() const;
+    ShuntingYard::Step step(int index) const;
+
+    // Index of the token processed next in a state, tokens().size() when none is left
+    int position(int state) const;
+    int outputLength(int state) const;
+    int outputTokenCount(int state) const;
+    // Operator stack in a state, bottom first
+    void operatorStack(int state, std::vector<Token> &stack) const;
+    bool isFinished(int state) const;
+
+    std::size_t memoryBytes() const;
+
+private:
+    struct Delta {
+        Token token;
+        // Output length and token count after the step
+        std::uint32_t outputLength;
+        std::uint32_t outputTokens;
+        // Entries popped off the stack before token is pushed
+        std::uint32_t pops;
+        std::uint8_t action;
+        bool pushes;
+        bool unmatchedParen;
+    };
+
+    struct Snapshot {
+        int state;
+        // Range of the stack contents in snapshotData
+        std::size_t begin;
+        std::size_t end;
+    };
+
+    std::string infix;
+    std::vector<Token> tokenList;
+    std::string postfix;
+    std::vector<Delta> deltas;
+    std::vector<Snapshot> snapshots;
+    std::vector<Token> snapshotData;
+};
+
+#endif // CONVERSIONTRACE_H
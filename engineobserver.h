@@ -0,0 +1,21 @@
+#ifndef ENGINEOBSERVER_H
+#define ENGINEOBSERVER_H
+
+#include "operationhistory.h"
+
+// Notification sent by the headless engines after every state change
+struct EngineEvent
+{
+    enum Type { Inserted, Removed, Cleared, Undone, Redone, Jumped, Overflow, Underflow } type;
+    // The operation that was applied, undone or redone; unused for Jumped
+    Operation op;
+};
+
+class EngineObserver
+{
+public:
+    virtual ~EngineObserver() = default;
+    virtual void engineChanged(const EngineEvent &event) = 0;
+};
+
+#endif // ENGINEOBSERVER_H
@@ -0,0 +1,120 @@
+#include "historymodel.h"
+#include <climits>
+
+namespace {
+// One repaint interval at 60 Hz
+const int FRAME_INTERVAL_MS = 16;
+}
+
+HistoryModel::HistoryModel(const OperationHistory *history, const QString &insertLabel,
+                           const QString &removeLabel, QObject *parent)
+    : QAbstractListModel(parent)
+    , history(history)
+    , insertLabel(insertLabel)
+    , removeLabel(removeLabel)
+    , shownBegin(0)
+    , shownEnd(0)
+    , dirtyFrom(INT_MAX)
+{
+    syncTimer.setSingleShot(true);
+    syncTimer.setInterval(FRAME_INTERVAL_MS);
+    connect(&syncTimer, &QTimer::timeout, this, &HistoryModel::sync);
+}
+
+int HistoryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : shownEnd - shownBegin;
+}
+
+QVariant HistoryModel::data(const QModelIndex &index, int role) const
+{
+    if (role != Qt::DisplayRole || !index.isValid()) {
+        return QVariant();
+    }
+    const int absolute = absoluteIndex(index.row());
+    if (absolute < history->beginIndex() || absolute >= history->endIndex()) {
+        // Dropped or truncated; the next sync removes the row
+        return QVariant();
+    }
+    return label(history->at(absolute));
+}
+
+QString HistoryModel::label(const Operation &op) const
+{
+    switch (op.type) {
+        case Operation::Insert:
+            return QString("%1 %2").arg(insertLabel).arg(op.value);
+        case Operation::Remove:
+            return QString("%1 %2").arg(removeLabel).arg(op.value);
+        case Operation::Clear:
+            return "Clear";
+    }
+    return QString();
+}
+
+int HistoryModel::absoluteIndex(int row) const
+{
+    return shownBegin + row;
+}
+
+int HistoryModel::rowOf(int absoluteIndex) const
+{
+    if (absoluteIndex < shownBegin || absoluteIndex >= shownEnd) {
+        return -1;
+    }
+    return absoluteIndex - shownBegin;
+}
+
+void HistoryModel::scheduleSync(int changedFrom)
+{
+    dirtyFrom = qMin(dirtyFrom, changedFrom);
+    if (!syncTimer.isActive()) {
+        syncTimer.start();
+    }
+}
+
+void HistoryModel::sync()
+{
+    syncTimer.stop();
+
+    // Entries dropped from the front by the memory budget
+    const int begin = history->beginIndex();
+    if (begin > shownBegin && shownEnd > shownBegin) {
+        const int dropped = qMin(begin, shownEnd) - shownBegin;
+        beginRemoveRows(QModelIndex(), 0, dropped - 1);
+        shownBegin += dropped;
+        endRemoveRows();
+    }
+    if (shownBegin == shownEnd) {
+        shownBegin = shownEnd = qMax(shownBegin, begin);
+    }
+
+    // A new operation after an undo replaces the redo tail
+    const int end = history->endIndex();
+    const int cut = qMax(shownBegin, qMin(dirtyFrom, end));
+    if (cut < shownEnd) {
+        beginRemoveRows(QModelIndex(), cut - shownBegin, shownEnd - shownBegin - 1);
+        shownEnd = cut;
+        endRemoveRows();
+    }
+    dirtyFrom = INT_MAX;
+
+    if (end > shownEnd) {
+        beginInsertRows(QModelIndex(), shownEnd - shownBegin, end - shownBegin - 1);
+        shownEnd = end;
+        endInsertRows();
+    }
+
+    emit synchronized();
+}
+
+void HistoryModel::reset()
+{
+    syncTimer.stop();
+    beginResetModel();
+    shownBegin = history->beginIndex();
+    shownEnd = history->endIndex();
+    dirtyFrom = INT_MAX;
+    endResetModel();
+    emit synchronized();
+}
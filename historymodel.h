@@ -0,0 +1,48 @@
+#ifndef HISTORYMODEL_H
+#define HISTORYMODEL_H
+
+#include <QAbstractListModel>
+#include <QTimer>
+#include "operationhistory.h"
+
+// List model over an engine's OperationHistory. Rows are formatted only when
+// a view asks for them, and structural changes are coalesced so that a burst
+// of operations produces a single rowsInserted per frame. Retention follows
+// the history's memory budget: entries it drops disappear from the front.
+class HistoryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    HistoryModel(const OperationHistory *history, const QString &insertLabel,
+                 const QString &removeLabel, QObject *parent = nullptr);
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role = Qt::DisplayRole) const override;
+
+    QString label(const Operation &op) const;
+    // Mapping between rows and absolute history indices
+    int absoluteIndex(int row) const;
+    int rowOf(int absoluteIndex) const;
+
+    // Entries from changedFrom onwards may have been replaced
+    void scheduleSync(int changedFrom);
+    // Applies pending changes right away
+    void sync();
+    // Rebuilds every row after the history was cleared wholesale
+    void reset();
+
+signals:
+    void synchronized();
+
+private:
+    const OperationHistory *history;
+    QString insertLabel;
+    QString removeLabel;
+    int shownBegin;
+    int shownEnd;
+    int dirtyFrom;
+    QTimer syncTimer;
+};
+
+#endif // HISTORYMODEL_H
@@ -1,18 +1,61 @@
 #include "infixtopostfix.h"
+#include "traceevents.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGraphicsRectItem>
+#include <QGraphicsSimpleTextItem>
 #include <QGraphicsTextItem>
 #include <QGraphicsProxyWidget>
 #include <QGroupBox>
 #include <QFont>
+#include <QElapsedTimer>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QLocale>
+#include <QSignalBlocker>
+#include <QSlider>
+#include <QSpinBox>
+#include <QTimer>
+#include "columnevaluator.h"
+#include <algorithm>
+#include <climits>
+#include <cmath>
+
+namespace {
+// Constants for visualization
+const int BOX_WIDTH = 40;
+const int BOX_HEIGHT = 40;
+const int SPACING = 5;
+const int INPUT_Y = 20;
+const int STACK_Y = 100;
+const int OUTPUT_Y = 180;
+const int EVAL_Y = 260;
+const int START_X = 50;
+
+const QColor HIGHLIGHT_COLOR("#FFB74D");
+const QColor STACK_COLOR("#81C784");
+const QColor OUTPUT_COLOR("#64B5F6");
+const QColor OPERAND_COLOR("#BA68C8");
+
+// Number of leading elements a and b have in common
+template <typename Sequence>
+int commonPrefix(const Sequence &a, const Sequence &b)
+{
+    const int n = int(std::min<size_t>(a.size(), b.size()));
+    return int(std::mismatch(a.begin(), a.begin() + n, b.begin()).first - a.begin());
+}
+}
 
 InfixToPostfix::InfixToPostfix(QWidget *parent)
     : QWidget(parent)
-    , currentIndex(0)
+    , currentState(0)
     , conversionInProgress(false)
-    , isAnimating(false)
-    , animationStep(0)
+    , playStartState(0)
+    , fileCancelRequested(false)
+    , evaluationInProgress(false)
+    , shownOutputCount(0)
+    , highlightedInput(-1)
+    , highlightedOutput(-1)
 {
     // Create main layout
     QVBoxLayout *mainLayout = new QVBoxLayout(this);
@@ -25,7 +68,7 @@ InfixToPostfix::InfixToPostfix(QWidget *parent)
     inputLayout->setSpacing(5);
     
     inputField = new QLineEdit(this);
-    inputField->setPlaceholderText("Enter infix expression (e.g., A+B*C)");
+    inputField->setPlaceholderText("Enter infix expression (e.g., 12*(x+y) - max(a, b) ^ 2)");
     inputField->setMinimumWidth(200);
     QFont inputFont = inputField->font();
     inputFont.setPointSize(10);
@@ -33,36 +76,99 @@ InfixToPostfix::InfixToPostfix(QWidget *parent)
 
     startButton = new QPushButton("Start", this);
     nextButton = new QPushButton("Next Step", this);
+    finishButton = new QPushButton("Run to End", this);
     resetButton = new QPushButton("Reset", this);
+    convertFileButton = new QPushButton("Convert File...", this);
+    convertFileButton->setToolTip("Convert an expression file of any size to a postfix file without loading it");
     
     // Style buttons
     QString buttonStyle = "QPushButton { padding: 5px 15px; }";
     startButton->setStyleSheet(buttonStyle);
     nextButton->setStyleSheet(buttonStyle);
+    finishButton->setStyleSheet(buttonStyle);
     resetButton->setStyleSheet(buttonStyle);
+    convertFileButton->setStyleSheet(buttonStyle);
     nextButton->setEnabled(false);
+    finishButton->setEnabled(false);
 
     inputLayout->addWidget(inputField, 3);
     inputLayout->addWidget(startButton, 1);
     inputLayout->addWidget(nextButton, 1);
+    inputLayout->addWidget(finishButton, 1);
     inputLayout->addWidget(resetButton, 1);
+    inputLayout->addWidget(convertFileButton, 1);
+
+    // Create evaluation group
+    QGroupBox *evalGroup = new QGroupBox("Evaluate Postfix", this);
+    QHBoxLayout *evalLayout = new QHBoxLayout(evalGroup);
+    evalLayout->setSpacing(5);
+
+    variablesField = new QLineEdit(this);
+    variablesField->setPlaceholderText("Variable values (e.g., A=1, B=2, C=3)");
+    variablesField->setFont(inputFont);
+
+    evalStepButton = new QPushButton("Evaluate Step", this);
+    evalRunButton = new QPushButton("Run Full Speed", this);
+    evalCsvButton = new QPushButton("Evaluate CSV...", this);
+    evalStepButton->setStyleSheet(buttonStyle);
+    evalRunButton->setStyleSheet(buttonStyle);
+    evalCsvButton->setStyleSheet(buttonStyle);
+    evalCsvButton->setToolTip("Evaluate the expression for every row of a CSV file whose header names the variables");
+    setEvaluationEnabled(false);
+
+    evalLayout->addWidget(variablesField, 3);
+    evalLayout->addWidget(evalStepButton, 1);
+    evalLayout->addWidget(evalRunButton, 1);
+    evalLayout->addWidget(evalCsvButton, 1);
 
     // Create visualization area
     QGroupBox *visualGroup = new QGroupBox("Visualization", this);
     QVBoxLayout *visualLayout = new QVBoxLayout(visualGroup);
     
     scene = new QGraphicsScene(this);
-    view = new QGraphicsView(scene);
+    view = new TimedGraphicsView(scene);
     view->setRenderHint(QPainter::Antialiasing);
-    view->setViewportUpdateMode(QGraphicsView::FullViewportUpdate);
     view->setHorizontalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     view->setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
     view->setMinimumHeight(200);
-    view->setMaximumHeight(250);
+    view->setMaximumHeight(320);
     view->setStyleSheet("QGraphicsView { background-color: #f8f9fa; border: 1px solid #dee2e6; }");
+    perfHud = new PerfHud("Infix to Postfix", view);
     
+    // Timeline over the recorded conversion
+    QHBoxLayout *timelineLayout = new QHBoxLayout;
+    timelineLayout->setSpacing(5);
+    playButton = new QPushButton("Play", this);
+    playButton->setStyleSheet(buttonStyle);
+    playButton->setEnabled(false);
+    timelineSlider = new QSlider(Qt::Horizontal, this);
+    timelineSlider->setRange(0, 0);
+    timelineSlider->setEnabled(false);
+    speedSpinBox = new QSpinBox(this);
+    speedSpinBox->setSuffix(" steps/s");
+    speedSpinBox->setRange(1, 10000);
+    speedSpinBox->setValue(5);
+    stepLabel = new QLabel(this);
+    stepLabel->setMinimumWidth(110);
+    timelineLayout->addWidget(playButton);
+    timelineLayout->addWidget(timelineSlider, 1);
+    timelineLayout->addWidget(speedSpinBox);
+    timelineLayout->addWidget(stepLabel);
+    playTimer = new QTimer(this);
+
+    visualLayout->addLayout(timelineLayout);
     visualLayout->addWidget(view);
 
+    inputTitle = scene->addText("Input Expression:");
+    inputTitle->setPos(START_X, INPUT_Y - 20);
+    stackTitle = scene->addText("Stack:");
+    stackTitle->setPos(START_X, STACK_Y - 20);
+    outputTitle = scene->addText("Output:");
+    outputTitle->setPos(START_X, OUTPUT_Y - 20);
+    evalTitle = scene->addText("Operand Stack:");
+    evalTitle->setPos(START_X, EVAL_Y - 20);
+    evalTitle->setVisible(false);
+
     // Create explanation area
     QGroupBox *explanationGroup = new QGroupBox("Step Explanation", this);
     QVBoxLayout *explanationLayout = new QVBoxLayout(explanationGroup);
@@ -85,46 +191,75 @@ InfixToPostfix::InfixToPostfix(QWidget *parent)
 
     // Add all groups to main layout
     mainLayout->addWidget(inputGroup);
+    mainLayout->addWidget(evalGroup);
     mainLayout->addWidget(visualGroup);
     mainLayout->addWidget(explanationGroup);
 
-    // Setup animation timer
-    animationTimer = new QTimer(this);
-    connect(animationTimer, &QTimer::timeout, this, &InfixToPostfix::updateVisualization);
-
     // Connect signals
     connect(startButton, &QPushButton::clicked, this, &InfixToPostfix::startConversion);
     connect(nextButton, &QPushButton::clicked, this, &InfixToPostfix::nextStep);
+    connect(finishButton, &QPushButton::clicked, this, [this]() { advanceConversion(INT_MAX); });
     connect(resetButton, &QPushButton::clicked, this, &InfixToPostfix::resetConversion);
+    connect(convertFileButton, &QPushButton::clicked, this, &InfixToPostfix::convertFile);
+    connect(playButton, &QPushButton::clicked, this, &InfixToPostfix::togglePlayback);
+    connect(playTimer, &QTimer::timeout, this, &InfixToPostfix::playTick);
+    connect(timelineSlider, &QSlider::valueChanged, this, [this](int state) {
+        showState(state);
+        // Playback continues from where the timeline was dragged to
+        playStartState = currentState;
+        playClock.restart();
+    });
+    connect(speedSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int speed) {
+        playStartState = currentState;
+        playClock.restart();
+        if (playTimer->isActive()) {
+            playTimer->setInterval(qMax(1000 / speed, 16));
+        }
+    });
+    connect(evalStepButton, &QPushButton::clicked, this, &InfixToPostfix::stepEvaluation);
+    connect(evalRunButton, &QPushButton::clicked, this, &InfixToPostfix::runEvaluation);
+    connect(evalCsvButton, &QPushButton::clicked, this, &InfixToPostfix::evaluateCsv);
+    connect(variablesField, &QLineEdit::textEdited, this, [this]() {
+        // New bindings restart any step-wise evaluation
+        evaluationInProgress = false;
+        updateVisualization();
+    });
 }
 
 InfixToPostfix::~InfixToPostfix()
 {
+    fileCancelRequested.store(true);
+    if (fileWorker.joinable()) {
+        fileWorker.join();
+    }
     delete scene;
 }
 
 void InfixToPostfix::startConversion()
 {
-    infixExpression = inputField->text().trimmed();
+    QString infixExpression = inputField->text().trimmed();
     if (infixExpression.isEmpty()) {
         explanationLabel->setText("Please enter an expression first!");
         return;
     }
 
-    // Initialize conversion
-    currentIndex = 0;
-    postfixResult.clear();
-    operatorStack.clear();
+    // Run the whole conversion once; the steps are then shown from the trace
+    stopPlayback();
+    trace.record(infixExpression.toStdString());
+    outputTokens = QString::fromStdString(trace.output()).split(' ', Qt::SkipEmptyParts);
     conversionInProgress = true;
+    evaluationInProgress = false;
     
     // Update UI state
     inputField->setEnabled(false);
     startButton->setEnabled(false);
-    nextButton->setEnabled(true);
+    timelineSlider->setRange(0, trace.stepCount());
+    timelineSlider->setEnabled(true);
+    playButton->setEnabled(true);
     
     // Start visualization
-    updateVisualization();
-    explanationLabel->setText("Conversion started. Click 'Next Step' to proceed.");
+    currentState = -1;
+    showState(0);
 }
 
 void InfixToPostfix::nextStep()
@@ -135,15 +270,24 @@ void InfixToPostfix::nextStep()
 void InfixToPostfix::resetConversion()
 {
     // Reset state
-    currentIndex = 0;
-    postfixResult.clear();
+    stopPlayback();
+    trace.clear();
     operatorStack.clear();
+    outputTokens.clear();
+    currentState = 0;
     conversionInProgress = false;
+    evaluationInProgress = false;
+    setEvaluationEnabled(false);
     
     // Reset UI
     inputField->setEnabled(true);
     startButton->setEnabled(true);
     nextButton->setEnabled(false);
+    finishButton->setEnabled(false);
+    timelineSlider->setRange(0, 0);
+    timelineSlider->setEnabled(false);
+    playButton->setEnabled(false);
+    stepLabel->setText("");
     explanationLabel->setText("");
     resultLabel->setText("");
     
@@ -153,131 +297,535 @@ void InfixToPostfix::resetConversion()
 
 void InfixToPostfix::processCurrentCharacter()
 {
-    if (currentIndex >= infixExpression.length()) {
-        // Pop all remaining operators from the stack
-        while (!operatorStack.isEmpty()) {
-            QChar op = operatorStack.pop();
-            if (op != '(' && op != ')') {
-                postfixResult += op;
-                explanationLabel->setText("Popping remaining operator: " + QString(op));
-            } else {
-                explanationLabel->setText("Found unmatched parenthesis - invalid expression");
-            }
-            updateVisualization();
-        }
-        
+    DSV_TRACE_SCOPE("InfixToPostfix::processCurrentCharacter");
+    advanceConversion(1);
+}
+
+void InfixToPostfix::advanceConversion(int steps)
+{
+    if (!conversionInProgress) return;
+    showState(currentState + qMin(steps, trace.stepCount() - currentState));
+}
+
+void InfixToPostfix::showState(int state)
+{
+    state = qBound(0, state, trace.stepCount());
+    if (state == currentState) return;
+
+    // Restores the operator stack from the nearest snapshot; every other
+    // part of the state is read straight from the trace
+    currentState = state;
+    trace.operatorStack(state, operatorStack);
+    perfHud->addOperations(1);
+    {
+        const QSignalBlocker blocker(timelineSlider);
+        timelineSlider->setValue(state);
+    }
+    stepLabel->setText(QString("Step %1 / %2").arg(state).arg(trace.stepCount()));
+
+    const bool finished = trace.isFinished(state);
+    nextButton->setEnabled(!finished);
+    finishButton->setEnabled(!finished);
+    if (state == 0) {
+        explanationLabel->setText("Conversion started. Click 'Next Step', play or drag the timeline to proceed.");
+    } else {
+        explanationLabel->setText(explainStep(trace.step(state - 1)));
+    }
+
+    if (finished) {
         // Conversion complete
-        nextButton->setEnabled(false);
+        stopPlayback();
         startButton->setEnabled(true);
-        conversionInProgress = false;
-        resultLabel->setText("Final Result: " + postfixResult);
+        const ShuntingYard::Step last = trace.step(state - 1);
+        resultLabel->setText("Final Result: " + QString::fromStdString(trace.output()));
+        setEvaluationEnabled(!last.unmatchedParen && !trace.output().empty());
+    } else {
+        // Evaluation needs the finished output
+        evaluationInProgress = false;
+        resultLabel->setText("");
+        setEvaluationEnabled(false);
+    }
+    updateVisualization();
+}
+
+void InfixToPostfix::togglePlayback()
+{
+    if (playTimer->isActive()) {
+        stopPlayback();
         return;
     }
 
-    QChar currentChar = infixExpression[currentIndex];
-    
-    if (currentChar.isLetterOrNumber()) {
-        postfixResult += currentChar;
-        explanationLabel->setText("Added operand: " + QString(currentChar));
+    // Playing from the end starts over
+    if (trace.isFinished(currentState)) {
+        showState(0);
+    }
+    playStartState = currentState;
+    playClock.start();
+    playButton->setText("Pause");
+    playTimer->start(qMax(1000 / speedSpinBox->value(), 16));
+}
+
+void InfixToPostfix::playTick()
+{
+    // Steps follow the clock, so fast speeds take several steps per tick
+    const qint64 due = playStartState + playClock.elapsed() * speedSpinBox->value() / 1000;
+    if (due > currentState) {
+        showState(int(qMin<qint64>(due, trace.stepCount())));
+    }
+}
+
+void InfixToPostfix::stopPlayback()
+{
+    playTimer->stop();
+    playButton->setText("Play");
+}
+
+void InfixToPostfix::setExpression(const QString &expression)
+{
+    inputField->setText(expression);
+}
+
+QGraphicsScene *InfixToPostfix::graphicsScene() const
+{
+    return scene;
+}
+
+QString InfixToPostfix::explainStep(const ShuntingYard::Step &step) const
+{
+    const QString symbol = tokenText(step.token);
+    switch (step.action) {
+        case ShuntingYard::Step::Operand:
+            return "Added operand: " + symbol;
+        case ShuntingYard::Step::OpenParen:
+            return "Pushed opening parenthesis onto stack";
+        case ShuntingYard::Step::CloseParen:
+            return "Processed closing parenthesis - popped operators until matching '('";
+        case ShuntingYard::Step::UnmatchedClose:
+            return "Error: Unmatched closing parenthesis";
+        case ShuntingYard::Step::Operator:
+            if (step.token.info().unary) {
+                return "Pushed unary minus (neg)";
+            }
+            return "Processed operator: " + symbol;
+        case ShuntingYard::Step::Function:
+            return "Pushed function " + symbol + " - it is output after its arguments";
+        case ShuntingYard::Step::Comma:
+            if (step.unmatchedParen) {
+                return "Error: Comma outside of a function call";
+            }
+            return "Processed argument separator - popped operators until '('";
+        case ShuntingYard::Step::Ignored:
+            return "Skipped character: " + symbol;
+        case ShuntingYard::Step::Finished:
+            if (step.unmatchedParen) {
+                return "Found unmatched parenthesis - invalid expression";
+            }
+            if (step.token.length) {
+                return "Popping remaining operator: " + symbol;
+            }
+            return "Reached end of expression";
     }
-    else if (currentChar == '(') {
-        operatorStack.push(currentChar);
-        explanationLabel->setText("Pushed opening parenthesis onto stack");
+    return QString();
+}
+
+QString InfixToPostfix::tokenText(const Token &token) const
+{
+    // Operators as they are written to postfix, so the unary minus reads "neg"
+    const std::string_view text = token.kind == Token::Operator ? token.info().postfix
+                                                                : token.text(trace.input());
+    return QString::fromUtf8(text.data(), int(text.size()));
+}
+
+void InfixToPostfix::setEvaluationEnabled(bool enabled)
+{
+    evalStepButton->setEnabled(enabled);
+    evalRunButton->setEnabled(enabled);
+    evalCsvButton->setEnabled(enabled);
+}
+
+bool InfixToPostfix::prepareEvaluation()
+{
+    std::string error;
+    if (!evaluator.compile(trace.output(), &error)) {
+        explanationLabel->setText("Cannot evaluate: " + QString::fromStdString(error));
+        return false;
     }
-    else if (currentChar == ')') {
-        while (!operatorStack.isEmpty() && operatorStack.top() != '(') {
-            postfixResult += operatorStack.pop();
+
+    // Parse "A=1, B=2" into the evaluator's variable slots
+    const std::vector<std::string> &names = evaluator.variables();
+    std::vector<bool> bound(names.size(), false);
+    variableValues.assign(names.size(), 0.0);
+    const QStringList bindings = variablesField->text().split(',', Qt::SkipEmptyParts);
+    for (const QString &binding : bindings) {
+        const int equals = binding.indexOf('=');
+        bool ok = false;
+        const double value = equals > 0 ? binding.mid(equals + 1).trimmed().toDouble(&ok) : 0.0;
+        if (!ok) {
+            explanationLabel->setText("Invalid variable binding: " + binding.trimmed());
+            return false;
         }
-        if (!operatorStack.isEmpty() && operatorStack.top() == '(') {
-            operatorStack.pop(); // Remove the '('
-            explanationLabel->setText("Processed closing parenthesis - popped operators until matching '('");
-        } else {
-            explanationLabel->setText("Error: Unmatched closing parenthesis");
+        const int index = evaluator.variableIndex(binding.left(equals).trimmed().toStdString());
+        if (index >= 0) {
+            variableValues[index] = value;
+            bound[index] = true;
         }
     }
-    else if (isOperator(currentChar)) {
-        while (!operatorStack.isEmpty() && operatorStack.top() != '(' &&
-               getPrecedence(operatorStack.top()) >= getPrecedence(currentChar)) {
-            postfixResult += operatorStack.pop();
+    for (size_t i = 0; i < names.size(); ++i) {
+        if (!bound[i]) {
+            explanationLabel->setText("No value given for variable " + QString::fromStdString(names[i]));
+            return false;
         }
-        operatorStack.push(currentChar);
-        explanationLabel->setText("Processed operator: " + QString(currentChar));
     }
+    return true;
+}
+
+void InfixToPostfix::stepEvaluation()
+{
+    if (!evaluationInProgress || evaluator.isDone()) {
+        if (!prepareEvaluation()) return;
+        evaluator.begin(variableValues.data());
+        evaluationInProgress = true;
+        resultLabel->setText("");
+    }
+
+    const PostfixEvaluator::Instruction ins = evaluator.program()[evaluator.pc()];
+    const double rhs = evaluator.depth() > 0 ? evaluator.stackValue(evaluator.depth() - 1) : 0.0;
+    const double lhs = evaluator.depth() > 1 ? evaluator.stackValue(evaluator.depth() - 2) : 0.0;
+    const QString symbol = outputTokens.value(evaluator.pc());
+    evaluator.step();
+    perfHud->addOperations(1);
 
-    currentIndex++;
+    switch (ins.op) {
+        case PostfixEvaluator::PushConst:
+            explanationLabel->setText("Pushed constant " + QString::number(evaluator.result()));
+            break;
+        case PostfixEvaluator::PushVar:
+            explanationLabel->setText(QString("Pushed variable %1 = %2").arg(symbol).arg(evaluator.result()));
+            break;
+        default:
+            if (PostfixEvaluator::arity(ins.op) == 1) {
+                explanationLabel->setText(QString("Popped %1, pushed %2(%1) = %3")
+                                              .arg(rhs).arg(symbol).arg(evaluator.result()));
+            } else {
+                explanationLabel->setText(QString("Popped %1 and %2, pushed %1 %3 %2 = %4")
+                                              .arg(lhs).arg(rhs).arg(symbol).arg(evaluator.result()));
+            }
+            break;
+    }
+
+    if (evaluator.isDone()) {
+        resultLabel->setText("Value: " + QString::number(evaluator.result()));
+    }
+    updateVisualization();
+}
+
+void InfixToPostfix::runEvaluation()
+{
+    if (!prepareEvaluation()) return;
+
+    // Evaluate repeatedly for a fixed wall-clock window to report throughput
+    const qint64 WINDOW_NS = 200000000;
+    const int BATCH = 256;
+    QElapsedTimer timer;
+    long long evaluations = 0;
+    double result = 0.0;
+    double sink = 0.0;
+    timer.start();
+    do {
+        for (int i = 0; i < BATCH; ++i) {
+            result = evaluator.evaluate(variableValues.data());
+            sink += result;
+        }
+        evaluations += BATCH;
+    } while (timer.nsecsElapsed() < WINDOW_NS);
+    const double seconds = timer.nsecsElapsed() / 1e9;
+    const double perSecond = evaluations / seconds;
+    const double instructionsPerSecond = perSecond * evaluator.program().size();
+
+    perfHud->addOperations(evaluations);
+    evaluationInProgress = false;
+    explanationLabel->setText(QString("Ran %1 evaluations in %2 ms (checksum %3)")
+                                  .arg(evaluations).arg(seconds * 1000.0, 0, 'f', 1).arg(sink, 0, 'g', 6));
+    resultLabel->setText(QString("Value: %1 - %2 evaluations/s, %3 instructions/s")
+                             .arg(result)
+                             .arg(perSecond, 0, 'f', 0)
+                             .arg(instructionsPerSecond, 0, 'f', 0));
+    updateVisualization();
+}
+
+void InfixToPostfix::evaluateCsv()
+{
+    std::string error;
+    if (!evaluator.compile(trace.output(), &error)) {
+        explanationLabel->setText("Cannot evaluate: " + QString::fromStdString(error));
+        return;
+    }
+
+    const QString path = QFileDialog::getOpenFileName(this, "Open CSV Columns", QString(),
+                                                      "CSV files (*.csv);;All files (*)");
+    if (path.isEmpty()) return;
+
+    ColumnTable table;
+    if (!table.load(path.toStdString(), &error)) {
+        explanationLabel->setText("Cannot load CSV: " + QString::fromStdString(error));
+        return;
+    }
+
+    // Bind each variable to the column with the same header name
+    std::vector<const double *> columns;
+    for (const std::string &name : evaluator.variables()) {
+        const int index = table.columnIndex(name);
+        if (index < 0) {
+            explanationLabel->setText("CSV has no column named " + QString::fromStdString(name));
+            return;
+        }
+        columns.push_back(table.columns[index].data());
+    }
+    if (table.rows == 0) {
+        explanationLabel->setText("CSV has no data rows");
+        return;
+    }
+
+    // Time the runtime-selected kernels against the scalar ones
+    std::vector<double> results(table.rows);
+    auto rowsPerSecond = [&](ColumnEvaluator::Isa isa) {
+        const qint64 WINDOW_NS = 100000000;
+        ColumnEvaluator columnEvaluator(isa);
+        QElapsedTimer timer;
+        long long runs = 0;
+        timer.start();
+        do {
+            columnEvaluator.evaluate(evaluator, columns.data(), table.rows, results.data());
+            runs++;
+        } while (timer.nsecsElapsed() < WINDOW_NS);
+        return runs * double(table.rows) / (timer.nsecsElapsed() / 1e9);
+    };
+    const ColumnEvaluator::Isa best = ColumnEvaluator::detectIsa();
+    const double scalarRate = rowsPerSecond(ColumnEvaluator::Scalar);
+    const double bestRate = best == ColumnEvaluator::Scalar ? scalarRate : rowsPerSecond(best);
+
+    evaluationInProgress = false;
+    explanationLabel->setText(QString("Evaluated %1 rows of %2 (first value %3, last value %4)")
+                                  .arg(table.rows)
+                                  .arg(QFileInfo(path).fileName())
+                                  .arg(results.front())
+                                  .arg(results.back()));
+    resultLabel->setText(QString("%1: %2 rows/s - Scalar: %3 rows/s (%4x)")
+                             .arg(ColumnEvaluator::isaName(best))
+                             .arg(bestRate, 0, 'f', 0)
+                             .arg(scalarRate, 0, 'f', 0)
+                             .arg(bestRate / scalarRate, 0, 'f', 2));
     updateVisualization();
 }
 
-bool InfixToPostfix::isOperator(QChar ch) const
+void InfixToPostfix::convertFile()
 {
-    return ch == '+' || ch == '-' || ch == '*' || ch == '/' || ch == '^';
+    if (fileWorker.joinable()) {
+        fileCancelRequested.store(true);
+        resultLabel->setText("Cancelling file conversion...");
+        return;
+    }
+
+    const QString inputPath = QFileDialog::getOpenFileName(this, "Convert Expression File", QString(),
+                                                           "Text files (*.txt);;All files (*)");
+    if (inputPath.isEmpty()) return;
+    const QString outputPath = QFileDialog::getSaveFileName(this, "Save Postfix", inputPath + ".postfix",
+                                                            "All files (*)");
+    if (outputPath.isEmpty()) return;
+
+    fileCancelRequested.store(false);
+    convertFileButton->setText("Cancel");
+    explanationLabel->setText(QString("Converting %1...").arg(QFileInfo(inputPath).fileName()));
+    resultLabel->setText("");
+
+    const std::string input = inputPath.toStdString();
+    const std::string output = outputPath.toStdString();
+    const double totalBytes = qMax(qint64(1), QFileInfo(inputPath).size());
+    fileWorker = std::thread([this, input, output, outputPath, totalBytes]() {
+        ShuntingYard::FileStats stats;
+        std::string error;
+        const bool ok = ShuntingYard::convertFile(input, output, &stats, &error, [&](std::uint64_t done) {
+            const int percent = int(100.0 * done / totalBytes);
+            QMetaObject::invokeMethod(this, [this, percent]() {
+                if (fileWorker.joinable()) resultLabel->setText(QString("Converting... %1%").arg(percent));
+            }, Qt::QueuedConnection);
+            return !fileCancelRequested.load();
+        });
+        const QString message = QString::fromStdString(error);
+        QMetaObject::invokeMethod(this, [this, ok, outputPath, stats, message]() {
+            fileConversionFinished(ok, outputPath, stats, message);
+        }, Qt::QueuedConnection);
+    });
 }
 
-int InfixToPostfix::getPrecedence(QChar op) const
+void InfixToPostfix::fileConversionFinished(bool ok, const QString &outputPath, const ShuntingYard::FileStats &stats,
+                                            const QString &error)
 {
-    switch (op.toLatin1()) {
-        case '^': return 3;
-        case '*':
-        case '/': return 2;
-        case '+':
-        case '-': return 1;
-        default: return 0;
+    if (fileWorker.joinable()) {
+        fileWorker.join();
+    }
+    convertFileButton->setText("Convert File...");
+    if (!ok) {
+        explanationLabel->setText("File conversion failed: " + error);
+        resultLabel->setText("");
+        return;
     }
+    QLocale locale;
+    explanationLabel->setText(QString("Wrote %1 bytes of postfix to %2 (%3 tokens, stack depth %4)%5")
+                                  .arg(locale.toString(qulonglong(stats.outputBytes)))
+                                  .arg(QFileInfo(outputPath).fileName())
+                                  .arg(locale.toString(qulonglong(stats.tokens)))
+                                  .arg(locale.toString(qulonglong(stats.maxStackDepth)))
+                                  .arg(stats.unmatchedParen ? " - unmatched parenthesis" : ""));
+    resultLabel->setText(QString("%1 MB in %2 s - %3 MB/s")
+                             .arg(stats.inputBytes / 1e6, 0, 'f', 1)
+                             .arg(stats.seconds, 0, 'f', 3)
+                             .arg(stats.megabytesPerSecond(), 0, 'f', 1));
 }
 
 void InfixToPostfix::updateVisualization()
 {
-    scene->clear();
+    DSV_TRACE_SCOPE("InfixToPostfix::updateVisualization");
+    PerfHud::UpdateScope timing(perfHud);
 
-    // Constants for visualization
-    const int BOX_WIDTH = 40;
-    const int BOX_HEIGHT = 40;
-    const int SPACING = 20;
-    const int INPUT_Y = 20;
-    const int STACK_Y = 100;
-    const int OUTPUT_Y = 180;
-    const int START_X = 50;
+    // A conversion step moves the highlight, pushes or pops a few stack
+    // cells and appends at most a few output cells; only those items change
+    syncInputRow();
+    syncStackRow();
+    syncOutputRow();
+    syncOperandRow();
+    fitContent();
+}
 
-    // Draw title for input expression
-    QGraphicsTextItem *inputTitle = scene->addText("Input Expression:");
-    inputTitle->setPos(START_X, INPUT_Y - 20);
-    
-    // Draw input expression with current position highlighted
-    QString input = inputField->text();
-    for (int i = 0; i < input.length(); ++i) {
-        QGraphicsRectItem *box = scene->addRect(START_X + i * (BOX_WIDTH + 5), INPUT_Y, BOX_WIDTH, BOX_HEIGHT);
-        if (i == currentIndex && conversionInProgress) {
-            box->setBrush(QColor("#FFB74D")); // Highlight current character
+void InfixToPostfix::syncInputRow()
+{
+    const QString input = inputField->text();
+    if (input != shownInput) {
+        // One cell per token, as the converter steps through them
+        const std::string source = input.toStdString();
+        QStringList tokens;
+        for (const Token &token : Tokenizer::tokenize(source)) {
+            const std::string_view text = token.text(source);
+            tokens.append(QString::fromUtf8(text.data(), int(text.size())));
         }
-        QGraphicsTextItem *text = scene->addText(QString(input[i]));
-        text->setPos(START_X + i * (BOX_WIDTH + 5) + BOX_WIDTH/4, INPUT_Y + BOX_HEIGHT/4);
+        const int kept = commonPrefix(shownInputTokens, tokens);
+        truncateRow(inputCells, kept);
+        if (highlightedInput >= kept) highlightedInput = -1;
+        for (int i = kept; i < tokens.size(); ++i) {
+            addCell(inputCells, INPUT_Y, BOX_WIDTH, Qt::NoBrush, tokens[i]);
+        }
+        shownInput = input;
+        shownInputTokens = tokens;
     }
+    const bool converting = conversionInProgress && !trace.isFinished(currentState);
+    moveHighlight(inputCells, highlightedInput, converting ? trace.position(currentState) : -1, Qt::NoBrush);
+}
 
-    // Draw title for stack
-    QGraphicsTextItem *stackTitle = scene->addText("Stack:");
-    stackTitle->setPos(START_X, STACK_Y - 20);
-    
-    // Draw stack
-    for (int i = 0; i < operatorStack.size(); ++i) {
-        QGraphicsRectItem *box = scene->addRect(START_X + i * (BOX_WIDTH + 5), STACK_Y, BOX_WIDTH, BOX_HEIGHT);
-        box->setBrush(QColor("#81C784")); // Green for stack
-        QGraphicsTextItem *text = scene->addText(QString(operatorStack[i]));
-        text->setPos(START_X + i * (BOX_WIDTH + 5) + BOX_WIDTH/4, STACK_Y + BOX_HEIGHT/4);
+void InfixToPostfix::syncStackRow()
+{
+    const int kept = commonPrefix(shownStack, operatorStack);
+    truncateRow(stackCells, kept);
+    for (int i = kept; i < static_cast<int>(operatorStack.size()); ++i) {
+        addCell(stackCells, STACK_Y, BOX_WIDTH, STACK_COLOR, tokenText(operatorStack[i]));
     }
+    shownStack = operatorStack;
+}
 
-    // Draw title for output
-    QGraphicsTextItem *outputTitle = scene->addText("Output:");
-    outputTitle->setPos(START_X, OUTPUT_Y - 20);
-    
-    // Draw postfix output
-    for (int i = 0; i < postfixResult.length(); ++i) {
-        QGraphicsRectItem *box = scene->addRect(START_X + i * (BOX_WIDTH + 5), OUTPUT_Y, BOX_WIDTH, BOX_HEIGHT);
-        box->setBrush(QColor("#64B5F6")); // Blue for output
-        QGraphicsTextItem *text = scene->addText(QString(postfixResult[i]));
-        text->setPos(START_X + i * (BOX_WIDTH + 5) + BOX_WIDTH/4, OUTPUT_Y + BOX_HEIGHT/4);
+void InfixToPostfix::syncOutputRow()
+{
+    // Every state shows a prefix of the final output
+    const int count = conversionInProgress ? trace.outputTokenCount(currentState) : 0;
+    if (count != shownOutputCount) {
+        const int kept = qMin(count, shownOutputCount);
+        truncateRow(outputCells, kept);
+        if (highlightedOutput >= kept) highlightedOutput = -1;
+        for (int i = kept; i < count; ++i) {
+            addCell(outputCells, OUTPUT_Y, BOX_WIDTH, OUTPUT_COLOR, outputTokens[i]);
+        }
+        shownOutputCount = count;
+    }
+    // Highlight the last evaluated symbol
+    moveHighlight(outputCells, highlightedOutput, evaluationInProgress ? evaluator.pc() - 1 : -1,
+                  OUTPUT_COLOR);
+}
+
+void InfixToPostfix::syncOperandRow()
+{
+    std::vector<double> operands;
+    if (evaluationInProgress) {
+        operands.reserve(evaluator.depth());
+        for (int i = 0; i < evaluator.depth(); ++i) {
+            operands.push_back(evaluator.stackValue(i));
+        }
+    }
+    evalTitle->setVisible(evaluationInProgress);
+
+    const int kept = commonPrefix(shownOperands, operands);
+    truncateRow(operandCells, kept);
+    for (int i = kept; i < static_cast<int>(operands.size()); ++i) {
+        addCell(operandCells, EVAL_Y, BOX_WIDTH * 2, OPERAND_COLOR, QString::number(operands[i], 'g', 6));
+    }
+    shownOperands.swap(operands);
+}
+
+void InfixToPostfix::addCell(QVector<Cell> &row, int y, int minWidth, const QBrush &brush, const QString &label)
+{
+    Cell cell;
+    // The label is a child of the box, so deleting the box removes both
+    cell.box = new QGraphicsRectItem;
+    cell.text = new QGraphicsSimpleTextItem(label, cell.box);
+    const QRectF bounds = cell.text->boundingRect();
+    const qreal x = row.isEmpty() ? START_X : row.last().box->rect().right() + SPACING;
+    cell.box->setRect(x, y, qMax<qreal>(minWidth, std::ceil(bounds.width()) + 12), BOX_HEIGHT);
+    cell.box->setBrush(brush);
+    scene->addItem(cell.box);
+    const QRectF rect = cell.box->rect();
+    cell.text->setPos(rect.center() - QPointF(bounds.width() / 2, bounds.height() / 2));
+    row.append(cell);
+}
+
+void InfixToPostfix::truncateRow(QVector<Cell> &row, int count)
+{
+    while (row.size() > count) {
+        delete row.takeLast().box;
+    }
+}
+
+void InfixToPostfix::moveHighlight(QVector<Cell> &row, int &highlighted, int index, const QBrush &normal)
+{
+    if (index >= row.size()) index = -1;
+    if (index == highlighted) return;
+
+    if (highlighted >= 0) {
+        row[highlighted].box->setBrush(normal);
+    }
+    highlighted = index;
+    if (index >= 0) {
+        row[index].box->setBrush(HIGHLIGHT_COLOR);
+    }
+}
+
+void InfixToPostfix::fitContent()
+{
+    // Computed from the last cell of each row; itemsBoundingRect() would
+    // visit every cell
+    auto rowRight = [](const QVector<Cell> &row) {
+        return row.isEmpty() ? qreal(START_X) : row.last().box->rect().right();
+    };
+    const qreal right = std::max({ rowRight(inputCells), rowRight(stackCells), rowRight(outputCells) });
+    QRectF content = inputTitle->sceneBoundingRect()
+                         .united(stackTitle->sceneBoundingRect())
+                         .united(outputTitle->sceneBoundingRect());
+    content = content.united(QRectF(START_X, INPUT_Y, right - START_X, OUTPUT_Y + BOX_HEIGHT - INPUT_Y));
+    if (evaluationInProgress) {
+        content = content.united(evalTitle->sceneBoundingRect());
+        content = content.united(QRectF(START_X, EVAL_Y, rowRight(operandCells) - START_X, BOX_HEIGHT));
     }
 
-    // Adjust view size to fit content
-    view->setSceneRect(scene->itemsBoundingRect());
-    view->fitInView(scene->itemsBoundingRect(), Qt::KeepAspectRatio);
+    // Refitting rescales and so repaints the whole view; skip it when the
+    // extent is unchanged
+    if (content == fittedRect) return;
+    fittedRect = content;
+    view->setSceneRect(content);
+    view->fitInView(content, Qt::KeepAspectRatio);
 }
@@ -5,10 +5,27 @@
 #include <QGraphicsScene>
 #include <QGraphicsView>
 #include <QStack>
-#include <QTimer>
 #include <QLineEdit>
 #include <QPushButton>
 #include <QLabel>
+#include <QElapsedTimer>
+#include <QStringList>
+#include <QVector>
+#include "postfixevaluator.h"
+#include "conversiontrace.h"
+#include "perfhud.h"
+#include "shuntingyard.h"
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+class QGraphicsRectItem;
+class QGraphicsSimpleTextItem;
+class QGraphicsTextItem;
+class QSlider;
+class QSpinBox;
+class QTimer;
 
 class InfixToPostfix : public QWidget
 {
@@ -18,44 +35,114 @@ public:
     explicit InfixToPostfix(QWidget *parent = nullptr);
     ~InfixToPostfix();
 
-private slots:
+    void setExpression(const QString &expression);
+    QGraphicsScene *graphicsScene() const;
+
+public slots:
     void startConversion();
     void nextStep();
+    // Applies up to steps conversion steps, then redraws once
+    void advanceConversion(int steps);
+
+private slots:
     void resetConversion();
+    void togglePlayback();
+    void playTick();
+    void stepEvaluation();
+    void runEvaluation();
+    void evaluateCsv();
+    // Streams a file through ShuntingYard::convertFile on a worker thread,
+    // or cancels the one running
+    void convertFile();
 
 private:
     // UI Elements
     QGraphicsScene *scene;
-    QGraphicsView *view;
+    TimedGraphicsView *view;
+    PerfHud *perfHud;
     QLineEdit *inputField;
     QPushButton *startButton;
     QPushButton *nextButton;
+    QPushButton *finishButton;
     QPushButton *resetButton;
+    QPushButton *convertFileButton;
+    QPushButton *playButton;
+    QSlider *timelineSlider;
+    QSpinBox *speedSpinBox;
+    QLabel *stepLabel;
+    QTimer *playTimer;
     QLabel *explanationLabel;
     QLabel *resultLabel;
+    QLineEdit *variablesField;
+    QPushButton *evalStepButton;
+    QPushButton *evalRunButton;
+    QPushButton *evalCsvButton;
 
-    // Conversion state
-    QString infixExpression;
-    QString postfixResult;
-    QStack<QChar> operatorStack;
-    int currentIndex;
+    // Conversion state: the recorded trace and the state shown from it
+    ConversionTrace trace;
+    int currentState;
+    std::vector<Token> operatorStack;
+    // Postfix tokens of the finished conversion
+    QStringList outputTokens;
     bool conversionInProgress;
+    // Playback runs on wall-clock time from this anchor
+    QElapsedTimer playClock;
+    int playStartState;
+
+    // File conversion, which runs off the GUI thread
+    std::thread fileWorker;
+    std::atomic<bool> fileCancelRequested;
+
+    // Evaluation state
+    PostfixEvaluator evaluator;
+    std::vector<double> variableValues;
+    bool evaluationInProgress;
 
-    // Animation
-    QTimer *animationTimer;
-    bool isAnimating;
-    int animationStep;
+    // Scene items persist between steps; updateVisualization() only touches
+    // the cells that differ from what is shown
+    struct Cell {
+        QGraphicsRectItem *box;
+        QGraphicsSimpleTextItem *text;
+    };
+    QGraphicsTextItem *inputTitle;
+    QGraphicsTextItem *stackTitle;
+    QGraphicsTextItem *outputTitle;
+    QGraphicsTextItem *evalTitle;
+    QVector<Cell> inputCells;
+    QVector<Cell> stackCells;
+    QVector<Cell> outputCells;
+    QVector<Cell> operandCells;
+    // What the cells currently show
+    QString shownInput;
+    QStringList shownInputTokens;
+    std::vector<Token> shownStack;
+    int shownOutputCount;
+    std::vector<double> shownOperands;
+    int highlightedInput;
+    int highlightedOutput;
+    QRectF fittedRect;
 
     // Helper functions
-    int getPrecedence(QChar op) const;
-    bool isOperator(QChar ch) const;
     void updateVisualization();
-    void drawOperatorStack();
-    void drawExpressionProgress();
-    void drawCurrentStep(const QString &stepExplanation);
-    void highlightCurrentCharacter();
+    void syncInputRow();
+    void syncStackRow();
+    void syncOutputRow();
+    void syncOperandRow();
+    void fitContent();
+    // Cells grow past minWidth to fit their label
+    void addCell(QVector<Cell> &row, int y, int minWidth, const QBrush &brush, const QString &label);
+    void truncateRow(QVector<Cell> &row, int count);
+    void moveHighlight(QVector<Cell> &row, int &highlighted, int index, const QBrush &normal);
     void processCurrentCharacter();
+    void showState(int state);
+    void stopPlayback();
     QString getCurrentStepExplanation() const;
+    QString explainStep(const ShuntingYard::Step &step) const;
+    QString tokenText(const Token &token) const;
+    bool prepareEvaluation();
+    void setEvaluationEnabled(bool enabled);
+    void fileConversionFinished(bool ok, const QString &outputPath, const ShuntingYard::FileStats &stats,
+                                const QString &error);
 };
 
 #endif // INFIXTOPOSTFIX_H
@@ -1,23 +1,31 @@
 #include "mainwindow.h"
+#include "startuptimeline.h"
+#include "traceevents.h"
 
 #include <QApplication>
-#include <QLocale>
-#include <QTranslator>
+#include <cstdio>
 
 int main(int argc, char *argv[])
 {
+    StartupTimeline::instance().start();
+    DSV_TRACE_THREAD_NAME("GUI");
     QApplication a(argc, argv);
+    StartupTimeline::instance().mark("QApplication");
 
-    QTranslator translator;
-    const QStringList uiLanguages = QLocale::system().uiLanguages();
-    for (const QString &locale : uiLanguages) {
-        const QString baseName = "DataStructureVisualizer_" + QLocale(locale).name();
-        if (translator.load(":/i18n/" + baseName)) {
-            a.installTranslator(&translator);
-            break;
-        }
-    }
+    // Translations and the window icon are loaded after the first paint
     MainWindow w;
+    StartupTimeline::instance().mark("MainWindow constructed");
     w.show();
-    return a.exec();
+    StartupTimeline::instance().mark("Window shown");
+    const int status = a.exec();
+
+#ifdef DSV_TRACING
+    // Scripted sessions name the output file up front
+    const QByteArray tracePath = qgetenv("DSV_TRACE_FILE");
+    std::string error;
+    if (!tracePath.isEmpty() && !TraceEvents::writeJson(tracePath.toStdString(), &error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+    }
+#endif
+    return status;
 }
@@ -3,6 +3,12 @@
 #include "stackvisualizer.h"
 #include "queuevisualizer.h"
 #include "infixtopostfix.h"
+#include "startuptimeline.h"
+#include "perfhud.h"
+#include "traceevents.h"
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFileDialog>
 #include <QInputDialog>
 #include <QPushButton>
 #include <QVBoxLayout>
@@ -16,32 +22,38 @@
 #include <QToolTip>
 #include <QScreen>
 #include <QStyle>
+#include <QTimer>
+#include <QTranslator>
+#include <QLocale>
+#include <cstdio>
 
 MainWindow::MainWindow(QWidget *parent)
     : QMainWindow(parent)
     , ui(new Ui::MainWindow)
+    , stackVisualizer(nullptr)
+    , queueVisualizer(nullptr)
+    , concurrentQueueLab(nullptr)
+    , infixToPostfix(nullptr)
+    , firstPaintPending(true)
 {
     ui->setupUi(this);
     
-    // Set window icon
-    QIcon appIcon(":/resources/logo.svg");
-    setWindowIcon(appIcon);
-    
     // Set initial window size
     resize(1024, 768);  
     setMinimumSize(800, 600);  
 
-    // Create visualizers
-    stackVisualizer = new StackVisualizer(this);
-    queueVisualizer = new QueueVisualizer(this);
-    infixToPostfix = new InfixToPostfix(this);
-
-    // Add tabs
+    // Add empty tab pages; visualizers are created on first activation
     tabWidget = new QTabWidget(this);
     setCentralWidget(tabWidget);
-    tabWidget->addTab(stackVisualizer, "Stack Visualizer");
-    tabWidget->addTab(queueVisualizer, "Queue Visualizer");
-    tabWidget->addTab(infixToPostfix, "Infix to Postfix");
+    const char *const tabTitles[] = {"Stack Visualizer", "Queue Visualizer", "Concurrent Queue Lab", "Infix to Postfix"};
+    for (const char *title : tabTitles) {
+        QWidget *page = new QWidget;
+        QVBoxLayout *pageLayout = new QVBoxLayout(page);
+        pageLayout->setContentsMargins(0, 0, 0, 0);
+        tabWidget->addTab(page, title);
+    }
+    ensureTab(tabWidget->currentIndex());
+    connect(tabWidget, &QTabWidget::currentChanged, this, &MainWindow::ensureTab);
 
     // Setup menu bar
     setupMenuBar();
@@ -68,8 +80,96 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+void MainWindow::ensureTab(int index)
+{
+    QWidget *page = tabWidget->widget(index);
+    if (!page || page->layout()->count() > 0) return;
+
+    QElapsedTimer buildClock;
+    buildClock.start();
+    QWidget *content = nullptr;
+    switch (index) {
+        case StackTab:
+            content = stackVisualizer = new StackVisualizer(page);
+            break;
+        case QueueTab:
+            content = queueVisualizer = new QueueVisualizer(page);
+            break;
+        case ConcurrentQueueTab:
+            content = concurrentQueueLab = new ConcurrentQueueLab(page);
+            break;
+        case InfixTab:
+            content = infixToPostfix = new InfixToPostfix(page);
+            break;
+        default:
+            return;
+    }
+    page->layout()->addWidget(content);
+    StartupTimeline::instance().mark(QString("Build tab \"%1\" (%2 ms)")
+                                         .arg(tabWidget->tabText(index))
+                                         .arg(buildClock.nsecsElapsed() / 1e6, 0, 'f', 2));
+}
+
+bool MainWindow::event(QEvent *event)
+{
+    if (event->type() == QEvent::Paint && firstPaintPending) {
+        // Children paint in the same pass; the zero timer fires once the
+        // whole frame has been flushed
+        firstPaintPending = false;
+        QTimer::singleShot(0, this, [this]() {
+            StartupTimeline::instance().markFirstPaint();
+            loadDeferredResources();
+        });
+    }
+    return QMainWindow::event(event);
+}
+
+void MainWindow::loadDeferredResources()
+{
+    // Set window icon
+    QIcon appIcon(":/resources/logo.svg");
+    setWindowIcon(appIcon);
+
+    // No string is translated before the first paint, so the translator can
+    // be probed for afterwards
+    QTranslator *translator = new QTranslator(this);
+    const QStringList uiLanguages = QLocale::system().uiLanguages();
+    for (const QString &locale : uiLanguages) {
+        const QString baseName = "DataStructureVisualizer_" + QLocale(locale).name();
+        if (translator->load(":/i18n/" + baseName)) {
+            QCoreApplication::installTranslator(translator);
+            break;
+        }
+    }
+    StartupTimeline::instance().mark("Deferred icon and translations");
+
+    const StartupTimeline &timeline = StartupTimeline::instance();
+    statusBar()->showMessage(QString("Ready - first paint after %1 ms").arg(timeline.firstPaintNs() / 1e6, 0, 'f', 1));
+    if (QCoreApplication::arguments().contains("--startup-trace") || qEnvironmentVariableIsSet("DSV_STARTUP_TRACE")) {
+        std::fputs(timeline.report().toLocal8Bit().constData(), stderr);
+        std::fflush(stderr);
+    }
+}
+
 void MainWindow::setupMenuBar()
 {
+    QMenu *viewMenu = menuBar()->addMenu("View");
+
+    // Performance overlay on every visualization
+    QAction *perfHudAction = viewMenu->addAction("Performance HUD");
+    perfHudAction->setCheckable(true);
+    perfHudAction->setShortcut(QKeySequence(Qt::Key_F3));
+    connect(perfHudAction, &QAction::toggled, this, [](bool checked) { PerfHud::setEnabled(checked); });
+
+    QAction *exportPerfAction = viewMenu->addAction("Export Performance CSV...");
+    connect(exportPerfAction, &QAction::triggered, this, &MainWindow::exportPerformanceCsv);
+
+#ifdef DSV_TRACING
+    // Chrome trace of the instrumented hot paths, for ui.perfetto.dev
+    QAction *exportTraceAction = viewMenu->addAction("Export Trace Events...");
+    connect(exportTraceAction, &QAction::triggered, this, &MainWindow::exportTraceEvents);
+#endif
+
     QMenu *helpMenu = menuBar()->addMenu("Help");
 
     // Stack help
@@ -86,6 +186,10 @@ void MainWindow::setupMenuBar()
 
     helpMenu->addSeparator();
 
+    // Startup timeline
+    QAction *startupAction = helpMenu->addAction("Startup Timeline");
+    connect(startupAction, &QAction::triggered, this, &MainWindow::showStartupTimeline);
+
     // About action
     QAction *aboutAction = helpMenu->addAction("About");
     connect(aboutAction, &QAction::triggered, this, &MainWindow::showAboutDialog);
@@ -102,8 +206,14 @@ void MainWindow::showStackHelp()
         "3. Peek: Views the top element without removing it\n"
         "   - Shows 'Stack is empty' if there are no elements\n\n"
         "4. Clear: Removes all elements from the stack\n\n"
+        "5. Work-Stealing Mode: Worker threads each own a deque; the owner\n"
+        "   pushes and pops at the bottom while idle workers steal from the top\n\n"
+        "6. Trace Replay: Load a trace file (one 'push N', 'pop' or 'clear' per\n"
+        "   line) and replay it at full speed; the view redraws at the chosen fps\n\n"
+        "7. Record Session: Logs every operation with its timestamp to a binary\n"
+        "   .dsvlog file until recording is stopped\n\n"
         "Stack Properties:\n"
-        "- Maximum capacity: 5 elements\n"
+        "- Default capacity: 5 elements (adjustable up to 100 million)\n"
         "- Last-In-First-Out (LIFO) principle\n"
         "- Elements are added and removed from the top";
     
@@ -123,8 +233,15 @@ void MainWindow::showQueueHelp()
         "4. Rear: Views the last element in the queue\n"
         "   - Shows 'Queue is empty' if there are no elements\n\n"
         "5. Clear: Removes all elements from the queue\n\n"
+        "6. Threaded SPSC Mode: A producer thread and a consumer thread share a\n"
+        "   lock-free ring; throughput and occupancy are sampled every frame\n\n"
+        "7. Trace Replay: Load a trace file (one 'enqueue N', 'dequeue' or 'clear'\n"
+        "   per line) and replay it at full speed; the view redraws at the chosen fps\n\n"
+        "8. Record Session: Logs every operation with its timestamp to a binary\n"
+        "   .dsvlog file until recording is stopped\n\n"
         "Queue Properties:\n"
-        "- Maximum capacity: 5 elements\n"
+        "- Default capacity: 5 elements (adjustable up to 10 million)\n"
+        "- Ctrl+wheel zooms large rings; zoomed out, occupancy is shown as bands\n"
         "- First-In-First-Out (FIFO) principle\n"
         "- Elements are added at rear and removed from front";
     
@@ -138,14 +255,69 @@ void MainWindow::showInfixToPostfixHelp()
         "1. Enter an infix expression (e.g., A+B*C)\n"
         "2. Click 'Start' to begin conversion\n"
         "3. Click 'Next Step' to proceed through each step\n"
-        "4. Use 'Reset' to start over\n\n"
+        "4. Drag the timeline to jump to any step, forwards or backwards, or\n"
+        "   'Play' the steps at the chosen speed\n"
+        "5. Use 'Reset' to start over\n"
+        "6. Once converted, enter variable values (e.g., A=1, B=2) and use\n"
+        "   'Evaluate Step' or 'Run Full Speed' to evaluate the postfix result\n"
+        "7. 'Evaluate CSV...' evaluates every row of a CSV file whose header\n"
+        "   names the variables and compares SIMD and scalar throughput\n"
+        "8. 'Convert File...' converts an expression file of any size to a\n"
+        "   postfix file and reports the throughput in MB/s\n\n"
+        "Operands are numbers (12, 3.5) and names (x1, rate); functions\n"
+        "sqrt, abs, exp, log, sin, cos, min, max and pow take their\n"
+        "arguments in parentheses, e.g. max(a, b).\n\n"
         "Operator Precedence:\n"
-        "^ (highest)\n"
-        "* /\n"
-        "+ - (lowest)\n\n"
+        "^ ** (highest, right-associative)\n"
+        "unary -\n"
+        "* / %\n"
+        "+ -\n"
+        "< <= > >=\n"
+        "== !=\n"
+        "&&\n"
+        "|| (lowest)\n\n"
         "The converter shows the stack operations and builds the postfix expression step by step.");
 }
 
+void MainWindow::exportPerformanceCsv()
+{
+    // Samples are only recorded while the HUD is shown
+    const QString path = QFileDialog::getSaveFileName(this, "Export Performance Samples", "dsv-performance.csv",
+                                                      "CSV files (*.csv)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!PerfHud::exportCsv(path, &error)) {
+        QMessageBox::warning(this, "Export Failed", error);
+        return;
+    }
+    statusBar()->showMessage("Performance samples written to " + path);
+}
+
+void MainWindow::exportTraceEvents()
+{
+    const QString path = QFileDialog::getSaveFileName(this, "Export Trace Events", "dsv-trace.json",
+                                                      "Chrome trace files (*.json)");
+    if (path.isEmpty()) return;
+
+    std::string error;
+    if (!TraceEvents::writeJson(path.toStdString(), &error)) {
+        QMessageBox::warning(this, "Export Failed", QString::fromStdString(error));
+        return;
+    }
+    statusBar()->showMessage("Trace events written to " + path);
+}
+
+void MainWindow::showStartupTimeline()
+{
+    QMessageBox box(this);
+    box.setWindowTitle("Startup Timeline");
+    box.setText("Time spent in each startup phase, measured from the start of main():");
+    box.setInformativeText(StartupTimeline::instance().report());
+    box.setStyleSheet("QLabel { font-family: monospace; }");
+    box.exec();
+}
+
 void MainWindow::showAboutDialog()
 {
     QString aboutText = 
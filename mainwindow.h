@@ -6,6 +6,7 @@
 #include "stackvisualizer.h"
 #include "queuevisualizer.h"
 #include "infixtopostfix.h"
+#include "concurrentqueuelab.h"
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -19,19 +20,32 @@ public:
     MainWindow(QWidget *parent = nullptr);
     ~MainWindow();
 
+protected:
+    bool event(QEvent *event) override;
+
 private slots:
     void showAboutDialog();
+    void showStartupTimeline();
+    void exportPerformanceCsv();
+    void exportTraceEvents();
     void showStackHelp();
     void showQueueHelp();
     void showInfixToPostfixHelp();
 
 private:
+    // Tab order; each tab's widget is built the first time it is shown
+    enum Tab { StackTab, QueueTab, ConcurrentQueueTab, InfixTab };
+
     Ui::MainWindow *ui;
     StackVisualizer *stackVisualizer;
     QueueVisualizer *queueVisualizer;
+    ConcurrentQueueLab *concurrentQueueLab;
     InfixToPostfix *infixToPostfix;
     QTabWidget *tabWidget;
+    bool firstPaintPending;
 
+    void ensureTab(int index);
+    void loadDeferredResources();
     void setupMenuBar();
     void createHelpMenu();
 };
@@ -0,0 +1,147 @@
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+#include <windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile()
+    : mapped(nullptr)
+    , length(0)
+    , opened(false)
+#ifdef _WIN32
+    , fileHandle(INVALID_HANDLE_VALUE)
+    , mappingHandle(nullptr)
+#endif
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string &path, std::string *error)
+{
+    close();
+
+    HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+                              FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        if (error) *error = "Cannot open " + path;
+        return false;
+    }
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(file, &fileSize)) {
+        CloseHandle(file);
+        if (error) *error = "Cannot read the size of " + path;
+        return false;
+    }
+
+    fileHandle = file;
+    length = static_cast<std::size_t>(fileSize.QuadPart);
+    opened = true;
+    if (length == 0) {
+        return true;
+    }
+
+    HANDLE mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    const void *view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (!view) {
+        if (mapping) CloseHandle(mapping);
+        close();
+        if (error) *error = "Cannot map " + path;
+        return false;
+    }
+    mappingHandle = mapping;
+    mapped = static_cast<const char *>(view);
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapped) UnmapViewOfFile(mapped);
+    if (mappingHandle) CloseHandle(mappingHandle);
+    if (fileHandle != INVALID_HANDLE_VALUE) CloseHandle(fileHandle);
+    mapped = nullptr;
+    mappingHandle = nullptr;
+    fileHandle = INVALID_HANDLE_VALUE;
+    length = 0;
+    opened = false;
+}
+
+#else
+
+bool MappedFile::open(const std::string &path, std::string *error)
+{
+    close();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        if (error) *error = "Cannot open " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    struct stat info;
+    if (fstat(fd, &info) != 0) {
+        if (error) *error = "Cannot stat " + path + ": " + std::strerror(errno);
+        ::close(fd);
+        return false;
+    }
+
+    length = static_cast<std::size_t>(info.st_size);
+    if (length > 0) {
+        void *view = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (view == MAP_FAILED) {
+            if (error) *error = "Cannot map " + path + ": " + std::strerror(errno);
+            ::close(fd);
+            length = 0;
+            return false;
+        }
+        // Traces are read front to back once
+        madvise(view, length, MADV_SEQUENTIAL);
+        mapped = static_cast<const char *>(view);
+    }
+
+    // The mapping keeps the file alive on its own
+    ::close(fd);
+    opened = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (mapped) munmap(const_cast<char *>(mapped), length);
+    mapped = nullptr;
+    length = 0;
+    opened = false;
+}
+
+#endif
+
+bool MappedFile::isOpen() const
+{
+    return opened;
+}
+
+const char *MappedFile::data() const
+{
+    return mapped;
+}
+
+std::size_t MappedFile::size() const
+{
+    return length;
+}
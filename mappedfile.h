@@ -0,0 +1,37 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <string>
+
+// Read-only memory mapping of a whole file (mmap on POSIX, a file mapping
+// on Windows). Pages are loaded by the OS on first touch, so opening a large
+// file costs no reads and no heap copy.
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isOpen() const;
+
+    // nullptr for an empty file
+    const char *data() const;
+    std::size_t size() const;
+
+private:
+    const char *mapped;
+    std::size_t length;
+    bool opened;
+#ifdef _WIN32
+    void *fileHandle;
+    void *mappingHandle;
+#endif
+};
+
+#endif // MAPPEDFILE_H
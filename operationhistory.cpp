@@ -0,0 +1,183 @@
+#include "operationhistory.h"
+#include <algorithm>
+
+namespace {
+template <typename Snapshots>
+typename Snapshots::const_iterator findAtOrBefore(const Snapshots &snapshots, int index)
+{
+    auto it = std::upper_bound(snapshots.begin(), snapshots.end(), index,
+                               [](int i, const typename Snapshots::value_type &s) { return i < s.index; });
+    return it == snapshots.begin() ? snapshots.end() : it - 1;
+}
+}
+
+OperationHistory::OperationHistory()
+    : base(0)
+    , current(-1)
+    , lastCheckpoint(-1)
+    , budget(DEFAULT_BUDGET)
+    , snapshotBytes(0)
+{
+}
+
+void OperationHistory::record(Operation op)
+{
+    truncateRedoTail();
+    entries.push_back(op);
+    current++;
+    enforceBudget();
+}
+
+void OperationHistory::recordClear(std::vector<int> clearedState)
+{
+    truncateRedoTail();
+    entries.push_back(Operation{Operation::Clear, 0});
+    current++;
+    snapshotBytes += bytesOf(clearedState);
+    clearSnapshots.push_back(Snapshot{current, std::move(clearedState)});
+    enforceBudget();
+}
+
+void OperationHistory::clear()
+{
+    entries.clear();
+    clearSnapshots.clear();
+    checkpoints.clear();
+    base = 0;
+    current = -1;
+    lastCheckpoint = -1;
+    snapshotBytes = 0;
+}
+
+bool OperationHistory::wantsCheckpoint(int stateSize) const
+{
+    return current - lastCheckpoint >= std::max(MIN_CHECKPOINT_INTERVAL, stateSize);
+}
+
+void OperationHistory::addCheckpoint(std::vector<int> state)
+{
+    snapshotBytes += bytesOf(state);
+    checkpoints.push_back(Checkpoint{current, std::move(state)});
+    lastCheckpoint = current;
+    enforceBudget();
+}
+
+const OperationHistory::Checkpoint *OperationHistory::checkpointAtOrBefore(int index) const
+{
+    auto it = findAtOrBefore(checkpoints, index);
+    return it == checkpoints.end() ? nullptr : &*it;
+}
+
+bool OperationHistory::canUndo() const
+{
+    return current >= base;
+}
+
+bool OperationHistory::canRedo() const
+{
+    return current < endIndex() - 1;
+}
+
+const Operation &OperationHistory::undo()
+{
+    return entries[current-- - base];
+}
+
+const Operation &OperationHistory::redo()
+{
+    return entries[++current - base];
+}
+
+void OperationHistory::setCurrentIndex(int index)
+{
+    current = index;
+}
+
+int OperationHistory::currentIndex() const
+{
+    return current;
+}
+
+int OperationHistory::beginIndex() const
+{
+    return base;
+}
+
+int OperationHistory::endIndex() const
+{
+    return base + static_cast<int>(entries.size());
+}
+
+int OperationHistory::size() const
+{
+    return static_cast<int>(entries.size());
+}
+
+const Operation &OperationHistory::at(int index) const
+{
+    return entries[index - base];
+}
+
+const std::vector<int> &OperationHistory::clearedState(int index) const
+{
+    return findAtOrBefore(clearSnapshots, index)->state;
+}
+
+void OperationHistory::setMemoryBudget(std::size_t bytes)
+{
+    budget = bytes;
+    enforceBudget();
+}
+
+std::size_t OperationHistory::memoryBudget() const
+{
+    return budget;
+}
+
+std::size_t OperationHistory::memoryUsage() const
+{
+    return entries.size() * sizeof(Operation) + snapshotBytes;
+}
+
+void OperationHistory::truncateRedoTail()
+{
+    // Drop any redo tail if we're in the middle of history
+    entries.resize(current + 1 - base);
+    while (!clearSnapshots.empty() && clearSnapshots.back().index > current) {
+        snapshotBytes -= bytesOf(clearSnapshots.back().state);
+        clearSnapshots.pop_back();
+    }
+    while (!checkpoints.empty() && checkpoints.back().index > current) {
+        snapshotBytes -= bytesOf(checkpoints.back().state);
+        checkpoints.pop_back();
+    }
+    lastCheckpoint = checkpoints.empty() ? std::min(lastCheckpoint, current) : checkpoints.back().index;
+}
+
+void OperationHistory::enforceBudget()
+{
+    // Forget the oldest entries first; the current entry is always kept
+    while (memoryUsage() > budget && base < current) {
+        entries.pop_front();
+        if (!clearSnapshots.empty() && clearSnapshots.front().index == base) {
+            snapshotBytes -= bytesOf(clearSnapshots.front().state);
+            clearSnapshots.pop_front();
+        }
+        base++;
+        // A checkpoint after entry base-1 still describes a reachable state
+        while (!checkpoints.empty() && checkpoints.front().index < base - 1) {
+            snapshotBytes -= bytesOf(checkpoints.front().state);
+            checkpoints.pop_front();
+        }
+    }
+    // Checkpoints alone can exceed a tiny budget; they are only an accelerator
+    while (memoryUsage() > budget && !checkpoints.empty()) {
+        snapshotBytes -= bytesOf(checkpoints.front().state);
+        checkpoints.pop_front();
+    }
+}
+
+std::size_t OperationHistory::bytesOf(const std::vector<int> &state)
+{
+    return state.size() * sizeof(int);
+}
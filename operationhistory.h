@@ -0,0 +1,85 @@
+#ifndef OPERATIONHISTORY_H
+#define OPERATIONHISTORY_H
+
+#include <cstddef>
+#include <deque>
+#include <vector>
+
+// A single undoable operation on a stack or queue engine
+struct Operation
+{
+    enum Type : unsigned char { Insert, Remove, Clear } type;
+    int value;
+};
+
+// Compact undo log. Insert/Remove entries carry only their opcode and value;
+// Clear keeps a snapshot of what it removed so it can be undone. Periodic
+// checkpoints of the full state let the engines seek to any index without
+// replaying the whole log. Indices are absolute: they keep growing while old
+// entries are dropped to stay within the memory budget.
+class OperationHistory
+{
+public:
+    static constexpr std::size_t DEFAULT_BUDGET = 64u * 1024 * 1024;
+    static constexpr int MIN_CHECKPOINT_INTERVAL = 64;
+
+    struct Checkpoint {
+        // State right after the entry at this index was applied
+        int index;
+        std::vector<int> state;
+    };
+
+    OperationHistory();
+
+    void record(Operation op);
+    void recordClear(std::vector<int> clearedState);
+    void clear();
+
+    // Checkpoints are spaced by at least the state size, so copying them
+    // costs O(1) amortized per recorded operation
+    bool wantsCheckpoint(int stateSize) const;
+    void addCheckpoint(std::vector<int> state);
+    // Latest checkpoint at or before index, or nullptr
+    const Checkpoint *checkpointAtOrBefore(int index) const;
+
+    bool canUndo() const;
+    bool canRedo() const;
+    const Operation &undo();
+    const Operation &redo();
+    // Moves the cursor without applying anything; used after a checkpoint restore
+    void setCurrentIndex(int index);
+
+    int currentIndex() const;
+    // Absolute index range of the retained entries: [beginIndex(), endIndex())
+    int beginIndex() const;
+    int endIndex() const;
+    int size() const;
+    const Operation &at(int index) const;
+    // Contents removed by the Clear entry at index
+    const std::vector<int> &clearedState(int index) const;
+
+    void setMemoryBudget(std::size_t bytes);
+    std::size_t memoryBudget() const;
+    std::size_t memoryUsage() const;
+
+private:
+    struct Snapshot {
+        int index;
+        std::vector<int> state;
+    };
+
+    std::deque<Operation> entries;
+    std::deque<Snapshot> clearSnapshots;
+    std::deque<Checkpoint> checkpoints;
+    int base;
+    int current;
+    int lastCheckpoint;
+    std::size_t budget;
+    std::size_t snapshotBytes;
+
+    void truncateRedoTail();
+    void enforceBudget();
+    static std::size_t bytesOf(const std::vector<int> &state);
+};
+
+#endif // OPERATIONHISTORY_H
@@ -0,0 +1,176 @@
+#include "operationtrace.h"
+#include <algorithm>
+#include <climits>
+#include <cstring>
+
+namespace {
+
+bool isSpace(char c)
+{
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+bool wordIs(const char *word, std::size_t length, const char *keyword)
+{
+    return std::strlen(keyword) == length && std::memcmp(word, keyword, length) == 0;
+}
+
+}
+
+OperationTrace::OperationTrace()
+    : cursor(nullptr)
+    , end(nullptr)
+    , opCount(0)
+    , consumed(0)
+    , peak(0)
+{
+}
+
+bool OperationTrace::open(const std::string &path, std::string *error)
+{
+    close();
+    if (!file.open(path, error)) {
+        return false;
+    }
+
+    // Validate every line up front and find the peak size
+    const char *p = file.data();
+    const char *stop = p + file.size();
+    long long size = 0;
+    long long maxSize = 0;
+    long long line = 1;
+    Operation op{Operation::Clear, 0};
+    for (;;) {
+        const char *lineStart = p;
+        const LineResult result = parseLine(p, stop, op);
+        if (result == End) break;
+        if (result == Invalid) {
+            const char *lineEnd = lineStart;
+            while (lineEnd < stop && *lineEnd != '\n') lineEnd++;
+            if (error) {
+                *error = "Line " + std::to_string(line) + ": cannot parse \"" +
+                         std::string(lineStart, std::min<std::size_t>(lineEnd - lineStart, 40)) + "\"";
+            }
+            close();
+            return false;
+        }
+        line++;
+        if (result == Skipped) continue;
+
+        opCount++;
+        switch (op.type) {
+            case Operation::Insert:
+                size++;
+                if (size > maxSize) maxSize = size;
+                break;
+            case Operation::Remove:
+                if (size > 0) size--;
+                break;
+            case Operation::Clear:
+                size = 0;
+                break;
+        }
+    }
+
+    peak = maxSize > INT_MAX ? INT_MAX : int(maxSize);
+    rewind();
+    return true;
+}
+
+void OperationTrace::close()
+{
+    file.close();
+    cursor = end = nullptr;
+    opCount = 0;
+    consumed = 0;
+    peak = 0;
+}
+
+bool OperationTrace::isOpen() const
+{
+    return file.isOpen();
+}
+
+void OperationTrace::rewind()
+{
+    cursor = file.data();
+    end = cursor + file.size();
+    consumed = 0;
+}
+
+long long OperationTrace::operationCount() const
+{
+    return opCount;
+}
+
+long long OperationTrace::position() const
+{
+    return consumed;
+}
+
+bool OperationTrace::atEnd() const
+{
+    return consumed >= opCount;
+}
+
+int OperationTrace::peakSize() const
+{
+    return peak;
+}
+
+std::size_t OperationTrace::bytes() const
+{
+    return file.size();
+}
+
+OperationTrace::LineResult OperationTrace::parseLine(const char *&p, const char *end, Operation &op)
+{
+    if (p >= end) return End;
+
+    while (p < end && isSpace(*p)) p++;
+    if (p == end) return Skipped;
+    if (*p == '\n' || *p == '#') {
+        while (p < end && *p != '\n') p++;
+        if (p < end) p++;
+        return Skipped;
+    }
+
+    const char *word = p;
+    while (p < end && !isSpace(*p) && *p != '\n') p++;
+    const std::size_t wordLength = std::size_t(p - word);
+    while (p < end && isSpace(*p)) p++;
+
+    LineResult result = Parsed;
+    if (wordIs(word, wordLength, "push") || wordIs(word, wordLength, "enqueue")) {
+        bool negative = false;
+        if (p < end && (*p == '-' || *p == '+')) {
+            negative = *p == '-';
+            p++;
+        }
+        long long value = 0;
+        const char *digits = p;
+        while (p < end && *p >= '0' && *p <= '9' && value <= INT_MAX) {
+            value = value * 10 + (*p - '0');
+            p++;
+        }
+        if (p == digits || value > (negative ? -(long long)INT_MIN : INT_MAX)) {
+            result = Invalid;
+        }
+        op = Operation{Operation::Insert, int(negative ? -value : value)};
+    } else if (wordIs(word, wordLength, "pop") || wordIs(word, wordLength, "dequeue")) {
+        op = Operation{Operation::Remove, 0};
+    } else if (wordIs(word, wordLength, "clear")) {
+        op = Operation{Operation::Clear, 0};
+    } else {
+        result = Invalid;
+    }
+
+    // Only trailing blanks may follow the operation
+    while (p < end && isSpace(*p)) p++;
+    if (p < end && *p != '\n') {
+        result = Invalid;
+    }
+    while (p < end && *p != '\n') p++;
+    if (p < end) p++;
+    return result;
+}
@@ -0,0 +1,64 @@
+#ifndef OPERATIONTRACE_H
+#define OPERATIONTRACE_H
+
+#include "mappedfile.h"
+#include "operationhistory.h"
+#include <string>
+
+// Memory-mapped text trace of engine operations, one per line:
+//
+//     push 42      enqueue 42
+//     pop          dequeue
+//     clear
+//
+// push/enqueue and pop/dequeue are synonyms, so one trace can drive either
+// engine. Blank lines and lines starting with '#' are ignored. The whole file
+// is validated once on open(); next() then parses straight out of the
+// mapping without copying.
+class OperationTrace
+{
+public:
+    OperationTrace();
+
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isOpen() const;
+    void rewind();
+
+    // Next operation, or false at the end of the trace
+    bool next(Operation &op)
+    {
+        for (;;) {
+            switch (parseLine(cursor, end, op)) {
+                case Parsed:
+                    consumed++;
+                    return true;
+                case Skipped:
+                    continue;
+                default:
+                    return false;
+            }
+        }
+    }
+
+    long long operationCount() const;
+    long long position() const;
+    bool atEnd() const;
+    // Largest size an engine reaches replaying the trace from empty
+    int peakSize() const;
+    std::size_t bytes() const;
+
+private:
+    enum LineResult { Parsed, Skipped, Invalid, End };
+
+    MappedFile file;
+    const char *cursor;
+    const char *end;
+    long long opCount;
+    long long consumed;
+    int peak;
+
+    static LineResult parseLine(const char *&p, const char *end, Operation &op);
+};
+
+#endif // OPERATIONTRACE_H
@@ -0,0 +1,246 @@
+#include "perfhud.h"
+#include <QEvent>
+#include <QFile>
+#include <QGraphicsScene>
+#include <QGraphicsView>
+#include <QLocale>
+#include <QTextStream>
+#include <QTimer>
+#include <algorithm>
+
+namespace {
+const int SAMPLE_INTERVAL_MS = 500;
+
+// Session clock shared by every view so exported samples line up
+QElapsedTimer &sessionClock()
+{
+    static QElapsedTimer clock;
+    if (!clock.isValid()) clock.start();
+    return clock;
+}
+}
+
+bool PerfHud::enabledFlag = false;
+
+QVector<PerfHud *> &PerfHud::instances()
+{
+    static QVector<PerfHud *> all;
+    return all;
+}
+
+PerfHud::PerfHud(const QString &viewName, TimedGraphicsView *view)
+    : QLabel(view)
+    , name(viewName)
+    , view(view)
+    , frames(0)
+    , paintNs(0)
+    , maxPaintNs(0)
+    , updates(0)
+    , updateNs(0)
+    , operations(0)
+{
+    setAttribute(Qt::WA_TransparentForMouseEvents);
+    setStyleSheet("QLabel { background-color: rgba(33, 37, 41, 200); color: #f8f9fa;"
+                  " font-family: monospace; font-size: 9pt; padding: 4px; border-radius: 3px; }");
+    setTextFormat(Qt::PlainText);
+
+    sampleTimer = new QTimer(this);
+    connect(sampleTimer, &QTimer::timeout, this, &PerfHud::takeSample);
+    view->installEventFilter(this);
+    view->setPerfHud(this);
+
+    sessionClock();
+    instances().append(this);
+    applyEnabled();
+}
+
+PerfHud::~PerfHud()
+{
+    instances().removeOne(this);
+}
+
+void PerfHud::setHistoryBytesSource(std::function<qint64()> source)
+{
+    historyBytes = source;
+}
+
+void PerfHud::beginUpdate()
+{
+    if (enabledFlag) updateClock.start();
+}
+
+void PerfHud::endUpdate()
+{
+    if (!enabledFlag || !updateClock.isValid()) return;
+    updateNs += updateClock.nsecsElapsed();
+    updates++;
+    updateClock.invalidate();
+}
+
+void PerfHud::beginPaint()
+{
+    if (enabledFlag) paintClock.start();
+}
+
+void PerfHud::endPaint()
+{
+    if (!enabledFlag || !paintClock.isValid()) return;
+    const qint64 ns = paintClock.nsecsElapsed();
+    paintNs += ns;
+    maxPaintNs = qMax(maxPaintNs, ns);
+    frames++;
+    paintClock.invalidate();
+}
+
+void PerfHud::addOperations(long long count)
+{
+    operations += count;
+}
+
+void PerfHud::setEnabled(bool enabled)
+{
+    enabledFlag = enabled;
+    for (PerfHud *hud : instances()) {
+        hud->applyEnabled();
+    }
+}
+
+bool PerfHud::isEnabled()
+{
+    return enabledFlag;
+}
+
+bool PerfHud::exportCsv(const QString &path, QString *error)
+{
+    struct Row {
+        const QString *view;
+        const Sample *sample;
+    };
+    QVector<Row> rows;
+    for (const PerfHud *hud : instances()) {
+        for (const Sample &sample : hud->samples) {
+            rows.append(Row{&hud->name, &sample});
+        }
+    }
+    std::stable_sort(rows.begin(), rows.end(), [](const Row &a, const Row &b) {
+        return a.sample->timeMs < b.sample->timeMs;
+    });
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Text)) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    QTextStream out(&file);
+    out << "time_ms,view,frame_ms,max_frame_ms,fps,scene_items,update_ms,updates,ops_per_s,history_bytes\n";
+    for (const Row &row : rows) {
+        const Sample &s = *row.sample;
+        out << s.timeMs << ',' << *row.view << ','
+            << QString::number(s.frameMs, 'f', 3) << ',' << QString::number(s.maxFrameMs, 'f', 3) << ','
+            << QString::number(s.framesPerSecond, 'f', 1) << ',' << s.sceneItems << ','
+            << QString::number(s.updateMs, 'f', 3) << ',' << s.updateCount << ','
+            << QString::number(s.opsPerSecond, 'f', 0) << ','
+            << s.historyBytes << '\n';
+    }
+    out.flush();
+    if (file.error() != QFile::NoError) {
+        if (error) *error = file.errorString();
+        return false;
+    }
+    return true;
+}
+
+bool PerfHud::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == view && event->type() == QEvent::Resize) {
+        reposition();
+    }
+    return QLabel::eventFilter(watched, event);
+}
+
+void PerfHud::applyEnabled()
+{
+    if (enabledFlag) {
+        resetInterval();
+        setText(name + ": sampling...");
+        reposition();
+        show();
+        raise();
+        sampleTimer->start(SAMPLE_INTERVAL_MS);
+    } else {
+        sampleTimer->stop();
+        hide();
+    }
+}
+
+void PerfHud::resetInterval()
+{
+    intervalClock.start();
+    frames = 0;
+    paintNs = 0;
+    maxPaintNs = 0;
+    updates = 0;
+    updateNs = 0;
+    operations = 0;
+}
+
+void PerfHud::takeSample()
+{
+    const double seconds = intervalClock.nsecsElapsed() / 1e9;
+    if (seconds <= 0.0) return;
+
+    Sample sample;
+    sample.timeMs = sessionClock().elapsed();
+    sample.frameMs = frames ? paintNs / 1e6 / frames : 0.0;
+    sample.maxFrameMs = maxPaintNs / 1e6;
+    sample.framesPerSecond = frames / seconds;
+    sample.sceneItems = view->scene() ? view->scene()->items().size() : 0;
+    sample.updateMs = updates ? updateNs / 1e6 / updates : 0.0;
+    sample.updateCount = updates;
+    sample.opsPerSecond = operations / seconds;
+    sample.historyBytes = historyBytes ? historyBytes() : 0;
+    samples.append(sample);
+    resetInterval();
+
+    QLocale locale;
+    QString text = QString("%1\n"
+                           "Paint   %2 ms avg, %3 ms max, %4 fps\n"
+                           "Scene   %5 items\n"
+                           "Update  %6 ms avg x %7\n"
+                           "Ops     %8 /s")
+                       .arg(name)
+                       .arg(sample.frameMs, 0, 'f', 2)
+                       .arg(sample.maxFrameMs, 0, 'f', 2)
+                       .arg(sample.framesPerSecond, 0, 'f', 0)
+                       .arg(locale.toString(sample.sceneItems))
+                       .arg(sample.updateMs, 0, 'f', 3)
+                       .arg(sample.updateCount)
+                       .arg(locale.toString(sample.opsPerSecond, 'f', 0));
+    if (historyBytes) {
+        text += QString("\nHistory %1 bytes").arg(locale.toString(sample.historyBytes));
+    }
+    setText(text);
+    adjustSize();
+}
+
+TimedGraphicsView::TimedGraphicsView(QGraphicsScene *scene, QWidget *parent)
+    : QGraphicsView(scene, parent)
+{
+}
+
+void TimedGraphicsView::setPerfHud(PerfHud *hud)
+{
+    this->hud = hud;
+}
+
+void TimedGraphicsView::paintEvent(QPaintEvent *event)
+{
+    PerfHud::PaintScope timing(hud);
+    QGraphicsView::paintEvent(event);
+}
+
+void PerfHud::reposition()
+{
+    const QRect area = view->viewport()->geometry();
+    move(area.topLeft() + QPoint(6, 6));
+}
@@ -0,0 +1,122 @@
+#ifndef PERFHUD_H
+#define PERFHUD_H
+
+#include <QLabel>
+#include <QElapsedTimer>
+#include <QGraphicsView>
+#include <QPointer>
+#include <QVector>
+#include <functional>
+
+class QTimer;
+class TimedGraphicsView;
+
+// Overlay in the corner of a visualizer's QGraphicsView. While enabled it
+// times every viewport paint, the owner's updateVisualization() passes and
+// the operations the owner reports, and every half second shows and records
+// a sample: paint time and rate, scene item count, update time, ops/s and
+// history memory. Samples from all views are kept for CSV export.
+class PerfHud : public QLabel
+{
+    Q_OBJECT
+
+public:
+    struct Sample {
+        qint64 timeMs;
+        double frameMs;
+        double maxFrameMs;
+        double framesPerSecond;
+        int sceneItems;
+        double updateMs;
+        int updateCount;
+        double opsPerSecond;
+        qint64 historyBytes;
+    };
+
+    // Times one updateVisualization() pass
+    class UpdateScope
+    {
+    public:
+        explicit UpdateScope(PerfHud *hud) : hud(hud) { if (hud) hud->beginUpdate(); }
+        ~UpdateScope() { if (hud) hud->endUpdate(); }
+
+    private:
+        PerfHud *hud;
+    };
+
+    // Times one viewport paint
+    class PaintScope
+    {
+    public:
+        explicit PaintScope(PerfHud *hud) : hud(hud) { if (hud) hud->beginPaint(); }
+        ~PaintScope() { if (hud) hud->endPaint(); }
+
+    private:
+        PerfHud *hud;
+    };
+
+    PerfHud(const QString &viewName, TimedGraphicsView *view);
+    ~PerfHud();
+
+    // History memory of the owner's engine; views without one leave it unset
+    void setHistoryBytesSource(std::function<qint64()> source);
+    void beginUpdate();
+    void endUpdate();
+    void beginPaint();
+    void endPaint();
+    void addOperations(long long count);
+
+    // Shows or hides the overlay on every view
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+    // Every sample recorded this session, oldest first
+    static bool exportCsv(const QString &path, QString *error = nullptr);
+
+protected:
+    bool eventFilter(QObject *watched, QEvent *event) override;
+
+private:
+    QString name;
+    TimedGraphicsView *view;
+    std::function<qint64()> historyBytes;
+    QTimer *sampleTimer;
+    QElapsedTimer intervalClock;
+    QElapsedTimer updateClock;
+    QElapsedTimer paintClock;
+    QVector<Sample> samples;
+
+    // Accumulated since the last sample
+    int frames;
+    qint64 paintNs;
+    qint64 maxPaintNs;
+    int updates;
+    qint64 updateNs;
+    long long operations;
+
+    void applyEnabled();
+    void resetInterval();
+    void takeSample();
+    void reposition();
+
+    static QVector<PerfHud *> &instances();
+    static bool enabledFlag;
+};
+
+// QGraphicsView that reports its paints to the PerfHud attached to it. The
+// paint is timed around QGraphicsView::paintEvent, since the scroll area
+// delivers viewport paints through its own event filter.
+class TimedGraphicsView : public QGraphicsView
+{
+public:
+    explicit TimedGraphicsView(QGraphicsScene *scene, QWidget *parent = nullptr);
+
+    void setPerfHud(PerfHud *hud);
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QPointer<PerfHud> hud;
+};
+
+#endif // PERFHUD_H
@@ -0,0 +1,267 @@
+#include "postfixevaluator.h"
+#include "tokenizer.h"
+#include <algorithm>
+#include <cmath>
+#include <string_view>
+
+namespace {
+struct Builtin {
+    std::string_view name;
+    PostfixEvaluator::OpCode op;
+    int arity;
+};
+
+// Postfix spellings of the operators in Operators::TABLE, plus the functions
+const Builtin BUILTINS[] = {
+    {"+", PostfixEvaluator::Add, 2},   {"-", PostfixEvaluator::Sub, 2},    {"*", PostfixEvaluator::Mul, 2},
+    {"/", PostfixEvaluator::Div, 2},   {"%", PostfixEvaluator::Mod, 2},    {"^", PostfixEvaluator::Pow, 2},
+    {"**", PostfixEvaluator::Pow, 2},  {"==", PostfixEvaluator::Eq, 2},    {"!=", PostfixEvaluator::Ne, 2},
+    {"<", PostfixEvaluator::Lt, 2},    {"<=", PostfixEvaluator::Le, 2},    {">", PostfixEvaluator::Gt, 2},
+    {">=", PostfixEvaluator::Ge, 2},   {"&&", PostfixEvaluator::And, 2},   {"||", PostfixEvaluator::Or, 2},
+    {"min", PostfixEvaluator::Min, 2}, {"max", PostfixEvaluator::Max, 2},  {"pow", PostfixEvaluator::Pow, 2},
+    {"neg", PostfixEvaluator::Neg, 1}, {"sqrt", PostfixEvaluator::Sqrt, 1}, {"abs", PostfixEvaluator::Abs, 1},
+    {"exp", PostfixEvaluator::Exp, 1}, {"log", PostfixEvaluator::Log, 1},  {"sin", PostfixEvaluator::Sin, 1},
+    {"cos", PostfixEvaluator::Cos, 1},
+};
+
+const Builtin *findBuiltin(std::string_view name)
+{
+    for (const Builtin &builtin : BUILTINS) {
+        if (builtin.name == name) return &builtin;
+    }
+    return nullptr;
+}
+
+// Digits with an optional fraction, as matched by Tokenizer; independent
+// of the C locale
+double parseNumber(std::string_view text)
+{
+    double value = 0.0;
+    std::size_t i = 0;
+    for (; i < text.size() && text[i] != '.'; i++) {
+        value = value * 10.0 + (text[i] - '0');
+    }
+    double scale = 1.0;
+    double fraction = 0.0;
+    for (i++; i < text.size(); i++) {
+        fraction = fraction * 10.0 + (text[i] - '0');
+        scale *= 10.0;
+    }
+    return value + fraction / scale;
+}
+}
+
+PostfixEvaluator::PostfixEvaluator()
+    : stepValues(nullptr)
+    , stepPc(0)
+    , stepDepth(0)
+    , compiled(false)
+{
+}
+
+bool PostfixEvaluator::compile(const std::string &postfix, std::string *error)
+{
+    code.clear();
+    constantPool.clear();
+    variableNames.clear();
+    compiled = false;
+
+    int depth = 0;
+    int maxDepth = 0;
+    Tokenizer tokenizer(postfix);
+    Token token;
+    while (tokenizer.next(token)) {
+        const std::string_view text = token.text(postfix);
+        if (token.kind == Token::Number) {
+            constantPool.push_back(parseNumber(text));
+            code.push_back(Instruction{PushConst, static_cast<int>(constantPool.size()) - 1});
+            depth++;
+            maxDepth = std::max(maxDepth, depth);
+            continue;
+        }
+
+        const Builtin *builtin = findBuiltin(text);
+        if (!builtin && token.kind == Token::Identifier) {
+            const std::string name(text);
+            int index = variableIndex(name);
+            if (index < 0) {
+                variableNames.push_back(name);
+                index = static_cast<int>(variableNames.size()) - 1;
+            }
+            code.push_back(Instruction{PushVar, index});
+            depth++;
+            maxDepth = std::max(maxDepth, depth);
+            continue;
+        }
+        if (!builtin) {
+            if (error) *error = "Unknown symbol '" + std::string(text) + "'";
+            return false;
+        }
+        if (depth < builtin->arity) {
+            if (error) *error = "Operator '" + std::string(text) + "' is missing an operand";
+            return false;
+        }
+        code.push_back(Instruction{builtin->op, 0});
+        depth -= builtin->arity - 1;
+    }
+
+    if (depth != 1) {
+        if (error) *error = depth == 0 ? "Empty expression" : "Too many operands";
+        return false;
+    }
+
+    stack.assign(maxDepth, 0.0);
+    compiled = true;
+    return true;
+}
+
+bool PostfixEvaluator::isCompiled() const
+{
+    return compiled;
+}
+
+const std::vector<PostfixEvaluator::Instruction> &PostfixEvaluator::program() const
+{
+    return code;
+}
+
+const std::vector<double> &PostfixEvaluator::constants() const
+{
+    return constantPool;
+}
+
+const std::vector<std::string> &PostfixEvaluator::variables() const
+{
+    return variableNames;
+}
+
+int PostfixEvaluator::variableIndex(const std::string &name) const
+{
+    auto it = std::find(variableNames.begin(), variableNames.end(), name);
+    return it == variableNames.end() ? -1 : static_cast<int>(it - variableNames.begin());
+}
+
+double PostfixEvaluator::evaluate(const double *values)
+{
+    double *sp = stack.data();
+    const double *constantsData = constantPool.data();
+    for (const Instruction &ins : code) {
+        switch (ins.op) {
+            case PushConst: *sp++ = constantsData[ins.operand]; break;
+            case PushVar:   *sp++ = values[ins.operand]; break;
+            case Add: sp--; sp[-1] += sp[0]; break;
+            case Sub: sp--; sp[-1] -= sp[0]; break;
+            case Mul: sp--; sp[-1] *= sp[0]; break;
+            case Div: sp--; sp[-1] /= sp[0]; break;
+            case Neg: sp[-1] = -sp[-1]; break;
+            default:
+                if (arity(ins.op) == 1) {
+                    sp[-1] = applyUnary(ins.op, sp[-1]);
+                } else {
+                    sp--;
+                    sp[-1] = applyBinary(ins.op, sp[-1], sp[0]);
+                }
+                break;
+        }
+    }
+    return stack[0];
+}
+
+void PostfixEvaluator::begin(const double *values)
+{
+    stepValues = values;
+    stepPc = 0;
+    stepDepth = 0;
+}
+
+bool PostfixEvaluator::step()
+{
+    if (isDone()) return false;
+
+    const Instruction &ins = code[stepPc++];
+    switch (ins.op) {
+        case PushConst:
+            stack[stepDepth++] = constantPool[ins.operand];
+            break;
+        case PushVar:
+            stack[stepDepth++] = stepValues[ins.operand];
+            break;
+        default:
+            if (arity(ins.op) == 1) {
+                stack[stepDepth - 1] = applyUnary(ins.op, stack[stepDepth - 1]);
+            } else {
+                stepDepth--;
+                stack[stepDepth - 1] = applyBinary(ins.op, stack[stepDepth - 1], stack[stepDepth]);
+            }
+            break;
+    }
+    return true;
+}
+
+bool PostfixEvaluator::isDone() const
+{
+    return !compiled || stepPc >= static_cast<int>(code.size());
+}
+
+int PostfixEvaluator::pc() const
+{
+    return stepPc;
+}
+
+int PostfixEvaluator::depth() const
+{
+    return stepDepth;
+}
+
+double PostfixEvaluator::stackValue(int index) const
+{
+    return stack[index];
+}
+
+double PostfixEvaluator::result() const
+{
+    return stepDepth > 0 ? stack[stepDepth - 1] : 0.0;
+}
+
+int PostfixEvaluator::arity(OpCode op)
+{
+    if (op <= PushVar) return 0;
+    return op >= Neg ? 1 : 2;
+}
+
+double PostfixEvaluator::applyUnary(OpCode op, double operand)
+{
+    switch (op) {
+        case Neg: return -operand;
+        case Sqrt: return std::sqrt(operand);
+        case Abs: return std::fabs(operand);
+        case Exp: return std::exp(operand);
+        case Log: return std::log(operand);
+        case Sin: return std::sin(operand);
+        case Cos: return std::cos(operand);
+        default: return 0.0;
+    }
+}
+
+double PostfixEvaluator::applyBinary(OpCode op, double lhs, double rhs)
+{
+    switch (op) {
+        case Add: return lhs + rhs;
+        case Sub: return lhs - rhs;
+        case Mul: return lhs * rhs;
+        case Div: return lhs / rhs;
+        case Mod: return std::fmod(lhs, rhs);
+        case Pow: return std::pow(lhs, rhs);
+        case Eq: return lhs == rhs ? 1.0 : 0.0;
+        case Ne: return lhs != rhs ? 1.0 : 0.0;
+        case Lt: return lhs < rhs ? 1.0 : 0.0;
+        case Le: return lhs <= rhs ? 1.0 : 0.0;
+        case Gt: return lhs > rhs ? 1.0 : 0.0;
+        case Ge: return lhs >= rhs ? 1.0 : 0.0;
+        case And: return lhs != 0.0 && rhs != 0.0 ? 1.0 : 0.0;
+        case Or: return lhs != 0.0 || rhs != 0.0 ? 1.0 : 0.0;
+        case Min: return std::min(lhs, rhs);
+        case Max: return std::max(lhs, rhs);
+        default: return 0.0;
+    }
+}
@@ -0,0 +1,68 @@
+#ifndef POSTFIXEVALUATOR_H
+#define POSTFIXEVALUATOR_H
+
+#include <string>
+#include <vector>
+
+// Compiles a postfix expression into a flat instruction array and evaluates
+// it on a value stack allocated once at compile time. Can run an evaluation
+// at full speed or one instruction at a time; has no GUI dependencies.
+class PostfixEvaluator
+{
+public:
+    // PushConst and PushVar come first; ColumnEvaluator relies on the order
+    enum OpCode : unsigned char {
+        PushConst, PushVar,
+        Add, Sub, Mul, Div, Mod, Pow, Eq, Ne, Lt, Le, Gt, Ge, And, Or, Min, Max,
+        Neg, Sqrt, Abs, Exp, Log, Sin, Cos
+    };
+
+    struct Instruction {
+        OpCode op;
+        // Index into constants() for PushConst, into variables() for PushVar
+        int operand;
+    };
+
+    PostfixEvaluator();
+
+    // Space-separated tokens as written by ShuntingYard: numbers are
+    // constants, operators and the names in the builtin table (neg, sqrt,
+    // abs, exp, log, sin, cos, min, max, pow) are operations, any other
+    // name is a variable. Comparisons and && / || give 1 or 0.
+    bool compile(const std::string &postfix, std::string *error = nullptr);
+    bool isCompiled() const;
+
+    const std::vector<Instruction> &program() const;
+    const std::vector<double> &constants() const;
+    const std::vector<std::string> &variables() const;
+    int variableIndex(const std::string &name) const;
+
+    // values is indexed like variables()
+    double evaluate(const double *values);
+
+    // Step-wise evaluation
+    void begin(const double *values);
+    bool step();
+    bool isDone() const;
+    int pc() const;
+    int depth() const;
+    double stackValue(int index) const;
+    double result() const;
+
+    // Operands an instruction pops: 0 for pushes, 1 or 2 otherwise
+    static int arity(OpCode op);
+    static double applyUnary(OpCode op, double operand);
+    static double applyBinary(OpCode op, double lhs, double rhs);
+
+private:
+    std::vector<Instruction> code;
+    std::vector<double> constantPool;
+    std::vector<std::string> variableNames;
+    std::vector<double> stack;
+    const double *stepValues;
+    int stepPc;
+    int stepDepth;
+    bool compiled;
+};
+
+#endif // POSTFIXEVALUATOR_H
@@ -0,0 +1,312 @@
+#include "queueengine.h"
+#include "traceevents.h"
+#include <algorithm>
+#include <cstdlib>
+
+QueueEngine::QueueEngine(int capacity)
+    : arr(capacity)
+    , head(0)
+    , count(0)
+    , maxSize(capacity)
+    , historyEnabled(true)
+    , observer(nullptr)
+{
+}
+
+bool QueueEngine::enqueue(int value)
+{
+    DSV_TRACE_SCOPE("QueueEngine::enqueue");
+    if (isFull()) {
+        notify(EngineEvent::Overflow, Operation{Operation::Insert, value});
+        return false;
+    }
+
+    arr[(head + count) % maxSize] = value;
+    count++;
+    if (historyEnabled) {
+        DSV_TRACE_SCOPE("addToHistory");
+        ops.record(Operation{Operation::Insert, value});
+        recorded();
+    }
+    notify(EngineEvent::Inserted, Operation{Operation::Insert, value});
+    return true;
+}
+
+int QueueEngine::dequeue()
+{
+    DSV_TRACE_SCOPE("QueueEngine::dequeue");
+    if (isEmpty()) {
+        notify(EngineEvent::Underflow, Operation{Operation::Remove, -1});
+        return -1;
+    }
+
+    int value = arr[head];
+    head = (head + 1) % maxSize;
+    count--;
+    if (count == 0) {
+        // An empty queue starts again from slot 0
+        head = 0;
+    }
+    if (historyEnabled) {
+        DSV_TRACE_SCOPE("addToHistory");
+        ops.record(Operation{Operation::Remove, value});
+        recorded();
+    }
+    notify(EngineEvent::Removed, Operation{Operation::Remove, value});
+    return value;
+}
+
+int QueueEngine::front() const
+{
+    if (isEmpty()) {
+        return -1;
+    }
+    return arr[head];
+}
+
+int QueueEngine::rear() const
+{
+    if (isEmpty()) {
+        return -1;
+    }
+    return arr[rearIndex()];
+}
+
+bool QueueEngine::isEmpty() const
+{
+    return count == 0;
+}
+
+bool QueueEngine::isFull() const
+{
+    return count == maxSize;
+}
+
+void QueueEngine::clear()
+{
+    DSV_TRACE_SCOPE("QueueEngine::clear");
+    if (isEmpty()) return;
+
+    if (historyEnabled) {
+        DSV_TRACE_SCOPE("addToHistory");
+        ops.recordClear(getCurrentState());
+    }
+    head = 0;
+    count = 0;
+    notify(EngineEvent::Cleared, Operation{Operation::Clear, 0});
+}
+
+bool QueueEngine::undo()
+{
+    DSV_TRACE_SCOPE("QueueEngine::undo");
+    if (!ops.canUndo()) return false;
+
+    const int index = ops.currentIndex();
+    const Operation &op = ops.undo();
+    revert(op, index);
+    notify(EngineEvent::Undone, op);
+    return true;
+}
+
+bool QueueEngine::redo()
+{
+    DSV_TRACE_SCOPE("QueueEngine::redo");
+    if (!ops.canRedo()) return false;
+
+    const Operation &op = ops.redo();
+    apply(op);
+    notify(EngineEvent::Redone, op);
+    return true;
+}
+
+bool QueueEngine::seek(int index)
+{
+    DSV_TRACE_SCOPE("QueueEngine::seek");
+    if (index < ops.beginIndex() - 1 || index >= ops.endIndex()) return false;
+
+    // Restore the nearest checkpoint when that beats stepping one by one
+    const OperationHistory::Checkpoint *checkpoint = ops.checkpointAtOrBefore(index);
+    const long long stepCost = std::abs(index - ops.currentIndex());
+    if (checkpoint && (index - checkpoint->index) + static_cast<long long>(checkpoint->state.size()) < stepCost) {
+        restore(checkpoint->state);
+        ops.setCurrentIndex(checkpoint->index);
+    }
+    while (ops.currentIndex() < index) {
+        apply(ops.redo());
+    }
+    while (ops.currentIndex() > index) {
+        const int current = ops.currentIndex();
+        revert(ops.undo(), current);
+    }
+
+    notify(EngineEvent::Jumped, Operation{Operation::Clear, 0});
+    return true;
+}
+
+int QueueEngine::size() const
+{
+    return count;
+}
+
+int QueueEngine::capacity() const
+{
+    return maxSize;
+}
+
+bool QueueEngine::setCapacity(int capacity)
+{
+    if (capacity < count || capacity < 1 || capacity > MAX_CAPACITY) {
+        return false;
+    }
+    relayout(capacity);
+    return true;
+}
+
+int QueueEngine::frontIndex() const
+{
+    return isEmpty() ? -1 : head;
+}
+
+int QueueEngine::rearIndex() const
+{
+    return isEmpty() ? -1 : (head + count - 1) % maxSize;
+}
+
+int QueueEngine::slot(int index) const
+{
+    return arr[index];
+}
+
+bool QueueEngine::isOccupied(int index) const
+{
+    if (isEmpty()) return false;
+    int relativePos = index - head;
+    if (relativePos < 0) relativePos += maxSize;
+    return relativePos < count;
+}
+
+std::vector<int> QueueEngine::getCurrentState() const
+{
+    std::vector<int> state;
+    state.reserve(count);
+    for (int i = 0; i < count; i++) {
+        state.push_back(arr[(head + i) % maxSize]);
+    }
+    return state;
+}
+
+const OperationHistory &QueueEngine::history() const
+{
+    return ops;
+}
+
+void QueueEngine::setHistoryEnabled(bool enabled)
+{
+    historyEnabled = enabled;
+}
+
+bool QueueEngine::isHistoryEnabled() const
+{
+    return historyEnabled;
+}
+
+void QueueEngine::setHistoryBudget(std::size_t bytes)
+{
+    ops.setMemoryBudget(bytes);
+}
+
+void QueueEngine::clearHistory()
+{
+    ops.clear();
+}
+
+void QueueEngine::setObserver(EngineObserver *observer)
+{
+    this->observer = observer;
+}
+
+void QueueEngine::recorded()
+{
+    if (ops.wantsCheckpoint(count)) {
+        ops.addCheckpoint(getCurrentState());
+    }
+}
+
+void QueueEngine::relayout(int capacity)
+{
+    std::vector<int> ring = getCurrentState();
+    ring.resize(capacity);
+    arr.swap(ring);
+    head = 0;
+    maxSize = capacity;
+}
+
+void QueueEngine::ensureRoom(int needed)
+{
+    if (needed <= maxSize) return;
+    // Doubling keeps a long replay from relaying out on every step
+    const long long doubled = std::min(2LL * maxSize, static_cast<long long>(MAX_CAPACITY));
+    relayout(static_cast<int>(std::max(static_cast<long long>(needed), doubled)));
+}
+
+void QueueEngine::apply(const Operation &op)
+{
+    switch (op.type) {
+        case Operation::Insert:
+            // Capacity may have been lowered since this entry was recorded
+            ensureRoom(count + 1);
+            arr[(head + count) % maxSize] = op.value;
+            count++;
+            break;
+        case Operation::Remove:
+            head = (head + 1) % maxSize;
+            count--;
+            if (count == 0) {
+                head = 0;
+            }
+            break;
+        case Operation::Clear:
+            head = 0;
+            count = 0;
+            break;
+    }
+}
+
+void QueueEngine::revert(const Operation &op, int index)
+{
+    switch (op.type) {
+        case Operation::Insert:
+            count--;
+            if (count == 0) {
+                head = 0;
+            }
+            break;
+        case Operation::Remove:
+            ensureRoom(count + 1);
+            head = (head - 1 + maxSize) % maxSize;
+            arr[head] = op.value;
+            count++;
+            break;
+        case Operation::Clear:
+            restore(ops.clearedState(index));
+            break;
+    }
+}
+
+void QueueEngine::restore(const std::vector<int> &state)
+{
+    const int needed = static_cast<int>(state.size());
+    // The old contents are overwritten, so the relayout need not copy them
+    head = 0;
+    count = 0;
+    ensureRoom(needed);
+    std::copy(state.begin(), state.end(), arr.begin());
+    count = needed;
+}
+
+void QueueEngine::notify(EngineEvent::Type type, Operation op)
+{
+    if (observer) {
+        observer->engineChanged(EngineEvent{type, op});
+    }
+}
@@ -0,0 +1,73 @@
+#ifndef QUEUEENGINE_H
+#define QUEUEENGINE_H
+
+#include "engineobserver.h"
+#include "operationhistory.h"
+#include <vector>
+
+// Circular array queue with undo/redo; has no GUI dependencies
+class QueueEngine
+{
+public:
+    static const int DEFAULT_CAPACITY = 5;
+    static const int MAX_CAPACITY = 1 << 28;
+
+    explicit QueueEngine(int capacity = DEFAULT_CAPACITY);
+
+    bool enqueue(int value);
+    int dequeue();
+    int front() const;
+    int rear() const;
+    bool isEmpty() const;
+    bool isFull() const;
+    void clear();
+    bool undo();
+    bool redo();
+    // Moves to the state right after history entry index (beginIndex() - 1
+    // for the oldest reachable state), via the nearest checkpoint if cheaper
+    bool seek(int index);
+
+    int size() const;
+    int capacity() const;
+    // Re-lays the ring out from slot 0; fails below the current size
+    bool setCapacity(int capacity);
+    // Ring positions of the front/rear elements, -1 when the queue is empty
+    int frontIndex() const;
+    int rearIndex() const;
+    // Raw slot access by ring position
+    int slot(int index) const;
+    bool isOccupied(int index) const;
+    std::vector<int> getCurrentState() const;
+
+    const OperationHistory &history() const;
+    // Bulk loads and benchmarks can bypass the undo history entirely
+    void setHistoryEnabled(bool enabled);
+    bool isHistoryEnabled() const;
+    void setHistoryBudget(std::size_t bytes);
+    // Forgets every recorded operation; the current state becomes the oldest
+    void clearHistory();
+    void setObserver(EngineObserver *observer);
+
+private:
+    std::vector<int> arr;
+    int head;
+    int count;
+    int maxSize;
+    OperationHistory ops;
+    bool historyEnabled;
+    EngineObserver *observer;
+
+    void recorded();
+    // Re-lays the ring out from slot 0 with capacity >= count slots
+    void relayout(int capacity);
+    // Makes room for needed elements while replaying history recorded under
+    // a larger capacity; never fails, since the history never held more
+    // than MAX_CAPACITY
+    void ensureRoom(int needed);
+    void apply(const Operation &op);
+    void revert(const Operation &op, int index);
+    void restore(const std::vector<int> &state);
+    void notify(EngineEvent::Type type, Operation op);
+};
+
+#endif // QUEUEENGINE_H
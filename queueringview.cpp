@@ -0,0 +1,451 @@
+#include "queueringview.h"
+#include "traceevents.h"
+#include "queueengine.h"
+#include "sceneanimator.h"
+#include <QGraphicsRectItem>
+#include <QGraphicsSimpleTextItem>
+#include <QHash>
+#include <QPainter>
+#include <QResizeEvent>
+#include <QScrollBar>
+#include <QStaticText>
+#include <QStyleOptionGraphicsItem>
+#include <QVector>
+#include <QWheelEvent>
+#include <cmath>
+
+namespace {
+const int BOX_WIDTH = 60;
+const int BOX_HEIGHT = 40;
+const int SPACING = 15;
+const int PITCH = BOX_WIDTH + SPACING;
+const int BASE_Y = 120;
+const int BASE_X = 50;
+const int FRAME_PADDING = 15;
+
+// Rings up to this size are always shown whole, like the classic view
+const int FIT_ALL_LIMIT = 12;
+// Level of detail thresholds, in screen pixels per slot
+const double CELL_MIN_PIXELS = 6.0;
+const double TEXT_MIN_PIXELS = 40.0;
+const double MAX_PIXELS_PER_SLOT = 300.0;
+
+const int ANIMATION_MS = 250;
+const qreal ANIMATION_RISE = 30.0;
+
+const QColor EMPTY_COLOR("#f0f0f0");
+const QColor OCCUPIED_COLOR("#81C784");
+
+// Labels cached per font before the cache is dropped and rebuilt
+const int STATIC_TEXT_CACHE_LIMIT = 4096;
+
+QRectF ringSlotRect(int index)
+{
+    return QRectF(BASE_X + index * PITCH, BASE_Y, BOX_WIDTH, BOX_HEIGHT);
+}
+
+// Text keeps a constant on-screen size and is centered on its anchor
+void centerText(QGraphicsSimpleTextItem *text, const QPointF &anchor)
+{
+    const QRectF bounds = text->boundingRect();
+    text->setTransform(QTransform::fromTranslate(-bounds.width() / 2, -bounds.height() / 2));
+    text->setPos(anchor);
+}
+}
+
+// Paints slots [first, last]: all boxes with one drawRects() call per fill
+// color, then the index and value labels from a QStaticText cache. Labels
+// are drawn in device coordinates so they keep their on-screen size.
+class QueueRingView::RingItem : public QGraphicsItem
+{
+public:
+    RingItem(const QFont &indexFont, const QFont &valueFont)
+        : engine(nullptr)
+        , indexFont(indexFont)
+        , valueFont(valueFont)
+        , first(0)
+        , last(-1)
+        , withText(false)
+        , skipped(-1)
+    {
+        setFlag(QGraphicsItem::ItemUsesExtendedStyleOption);
+    }
+
+    void setEngine(const QueueEngine *engine)
+    {
+        this->engine = engine;
+    }
+
+    // Every call repaints, since slot contents may have changed
+    void setRange(int first, int last, bool withText)
+    {
+        if (first != this->first || last != this->last) {
+            prepareGeometryChange();
+            this->first = first;
+            this->last = last;
+        }
+        this->withText = withText;
+        update();
+    }
+
+    // Leaves out the value of slot, which a stand-in item is drawing
+    void setSkippedSlot(int slot)
+    {
+        if (skipped == slot) return;
+        skipped = slot;
+        update();
+    }
+
+    bool showsText(int slot) const
+    {
+        return withText && slot >= first && slot <= last;
+    }
+
+    QRectF boundingRect() const override
+    {
+        if (last < first) return QRectF();
+        return QRectF(ringSlotRect(first).left(), BASE_Y - 45,
+                      (last - first + 1) * PITCH - SPACING, BOX_HEIGHT + 50);
+    }
+
+    void paint(QPainter *painter, const QStyleOptionGraphicsItem *option, QWidget *) override
+    {
+        if (!engine || last < first) return;
+
+        // Only the exposed part of the range is drawn
+        const QRectF exposed = option->exposedRect;
+        const int from = qMax(first, int(std::floor((exposed.left() - BASE_X) / PITCH)));
+        const int to = qMin(last, int(std::floor((exposed.right() - BASE_X) / PITCH)));
+        if (to < from) return;
+
+        emptyRects.clear();
+        occupiedRects.clear();
+        for (int slot = from; slot <= to; slot++) {
+            (engine->isOccupied(slot) ? occupiedRects : emptyRects).append(ringSlotRect(slot));
+        }
+        painter->setPen(QPen(Qt::black));
+        painter->setBrush(EMPTY_COLOR);
+        painter->drawRects(emptyRects.constData(), emptyRects.size());
+        painter->setBrush(OCCUPIED_COLOR);
+        painter->drawRects(occupiedRects.constData(), occupiedRects.size());
+        if (!withText) return;
+
+        const QTransform toDevice = painter->worldTransform();
+        painter->save();
+        painter->resetTransform();
+        painter->setFont(indexFont);
+        painter->setPen(Qt::darkGray);
+        for (int slot = from; slot <= to; slot++) {
+            const QPointF anchor = toDevice.map(QPointF(ringSlotRect(slot).center().x(), BASE_Y - 25));
+            drawCentered(painter, label(indexTexts, slot, indexFont), anchor);
+        }
+        painter->setFont(valueFont);
+        painter->setPen(Qt::black);
+        for (int slot = from; slot <= to; slot++) {
+            if (slot == skipped || !engine->isOccupied(slot)) continue;
+            const QPointF anchor = toDevice.map(ringSlotRect(slot).center());
+            drawCentered(painter, label(valueTexts, engine->slot(slot), valueFont), anchor);
+        }
+        painter->restore();
+    }
+
+private:
+    const QueueEngine *engine;
+    QFont indexFont;
+    QFont valueFont;
+    int first;
+    int last;
+    bool withText;
+    int skipped;
+    // Reused by every paint
+    QVector<QRectF> emptyRects;
+    QVector<QRectF> occupiedRects;
+    QHash<int, QStaticText> indexTexts;
+    QHash<int, QStaticText> valueTexts;
+
+    static const QStaticText &label(QHash<int, QStaticText> &cache, int number, const QFont &font)
+    {
+        auto it = cache.find(number);
+        if (it == cache.end()) {
+            if (cache.size() >= STATIC_TEXT_CACHE_LIMIT) {
+                cache.clear();
+            }
+            QStaticText text(QString::number(number));
+            text.setTextFormat(Qt::PlainText);
+            text.prepare(QTransform(), font);
+            it = cache.insert(number, text);
+        }
+        return it.value();
+    }
+
+    static void drawCentered(QPainter *painter, const QStaticText &text, const QPointF &anchor)
+    {
+        const QSizeF size = text.size();
+        painter->drawStaticText(anchor - QPointF(size.width() / 2, size.height() / 2), text);
+    }
+};
+
+QueueRingView::QueueRingView(QGraphicsScene *scene, QWidget *parent)
+    : TimedGraphicsView(scene, parent)
+    , engine(nullptr)
+    , arrivingSlot(-1)
+    , arrivingValue(0)
+    , layoutCapacity(0)
+    , fitAll(true)
+{
+    setTransformationAnchor(QGraphicsView::AnchorUnderMouse);
+    setVerticalScrollBarPolicy(Qt::ScrollBarAlwaysOff);
+    setHorizontalScrollBarPolicy(Qt::ScrollBarAsNeeded);
+
+    indexFont.setPointSize(10);
+    valueFont.setPointSize(12);
+
+    ring = new RingItem(indexFont, valueFont);
+    scene->addItem(ring);
+
+    emptyBand = scene->addRect(QRectF(), Qt::NoPen, EMPTY_COLOR);
+    for (QGraphicsRectItem *&band : occupiedBands) {
+        band = scene->addRect(QRectF(), Qt::NoPen, OCCUPIED_COLOR);
+    }
+    hideBands();
+
+    frame = scene->addRect(QRectF(), QPen(Qt::black, 2), Qt::NoBrush);
+    frame->setZValue(-1);
+
+    frontLabel = scene->addSimpleText("Front", indexFont);
+    frontLabel->setBrush(Qt::blue);
+    frontLabel->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+    rearLabel = scene->addSimpleText("Rear", indexFont);
+    rearLabel->setBrush(Qt::red);
+    rearLabel->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+
+    arrivingText = scene->addSimpleText(QString(), valueFont);
+    arrivingText->setBrush(Qt::black);
+    arrivingText->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+    arrivingText->setVisible(false);
+
+    departingText = scene->addSimpleText(QString(), valueFont);
+    departingText->setBrush(Qt::black);
+    departingText->setFlag(QGraphicsItem::ItemIgnoresTransformations);
+    departingText->setVisible(false);
+
+    animator = new SceneAnimator(this);
+}
+
+void QueueRingView::setEngine(const QueueEngine *engine)
+{
+    this->engine = engine;
+    ring->setEngine(engine);
+    relayout();
+}
+
+void QueueRingView::relayout()
+{
+    if (!engine) return;
+
+    layoutCapacity = engine->capacity();
+    frame->setRect(BASE_X - FRAME_PADDING, BASE_Y - FRAME_PADDING,
+                   layoutCapacity * PITCH - SPACING + 2 * FRAME_PADDING,
+                   BOX_HEIGHT + 2 * FRAME_PADDING);
+    const QRectF bounds = frame->rect().adjusted(-20, -60, 20, 60);
+    setSceneRect(bounds);
+
+    // Small rings fit the view; large ones start at one cell per cell height
+    fitAll = layoutCapacity <= FIT_ALL_LIMIT;
+    const qreal sy = viewport()->height() / bounds.height();
+    if (fitAll) {
+        const qreal s = qMin(sy, viewport()->width() / bounds.width());
+        setTransform(QTransform::fromScale(s, s));
+    } else {
+        setTransform(QTransform::fromScale(sy, sy));
+        centerOn(slotRect(qMax(engine->frontIndex(), 0)).center());
+    }
+    refresh();
+}
+
+void QueueRingView::refresh()
+{
+    DSV_TRACE_SCOPE("QueueRingView::refresh");
+    if (!engine || engine->capacity() != layoutCapacity) {
+        if (engine) relayout();
+        return;
+    }
+
+    int first = 0;
+    int last = -1;
+    visibleSlots(first, last);
+
+    const double pixels = pixelsPerSlot();
+    if (pixels >= CELL_MIN_PIXELS) {
+        hideBands();
+        ring->setRange(first, last, pixels >= TEXT_MIN_PIXELS);
+    } else {
+        ring->setRange(0, -1, false);
+        showBands(first, last);
+    }
+
+    // The ring takes over an arrived value once its slot changes or the
+    // value is no longer shown
+    if (arrivingSlot >= 0 && (!isTextShown(arrivingSlot) || !engine->isOccupied(arrivingSlot) ||
+                              engine->slot(arrivingSlot) != arrivingValue)) {
+        settleArrival();
+    }
+
+    frontLabel->setVisible(!engine->isEmpty());
+    rearLabel->setVisible(!engine->isEmpty());
+    if (!engine->isEmpty()) {
+        placeLabel(frontLabel, engine->frontIndex(), BASE_Y - 45);
+        placeLabel(rearLabel, engine->rearIndex(), BASE_Y + BOX_HEIGHT + 30);
+    }
+}
+
+void QueueRingView::animateEnqueue(int slot)
+{
+    DSV_TRACE_SCOPE("QueueRingView::animateEnqueue");
+    settleArrival();
+    if (!isTextShown(slot) || !engine->isOccupied(slot)) return;
+
+    arrivingSlot = slot;
+    arrivingValue = engine->slot(slot);
+    ring->setSkippedSlot(slot);
+    arrivingText->setText(QString::number(arrivingValue));
+    centerText(arrivingText, slotRect(slot).center());
+    arrivingText->setVisible(true);
+    const QPointF rest = arrivingText->pos();
+    animator->animatePos(arrivingText, rest - QPointF(0, ANIMATION_RISE), rest, ANIMATION_MS);
+    animator->animateOpacity(arrivingText, 0.0, 1.0, ANIMATION_MS);
+}
+
+void QueueRingView::animateDequeue(int slot, int value)
+{
+    DSV_TRACE_SCOPE("QueueRingView::animateDequeue");
+    if (!isTextShown(slot)) return;
+
+    departingText->setText(QString::number(value));
+    centerText(departingText, slotRect(slot).center());
+    departingText->setVisible(true);
+    const QPointF start = departingText->pos();
+    animator->animatePos(departingText, start, start - QPointF(0, ANIMATION_RISE), ANIMATION_MS);
+    animator->animateOpacity(departingText, 1.0, 0.0, ANIMATION_MS, true);
+}
+
+void QueueRingView::settleArrival()
+{
+    if (arrivingSlot < 0) return;
+
+    animator->finish(arrivingText);
+    arrivingText->setVisible(false);
+    arrivingSlot = -1;
+    ring->setSkippedSlot(-1);
+}
+
+bool QueueRingView::isTextShown(int slot) const
+{
+    return ring->showsText(slot);
+}
+
+void QueueRingView::resizeEvent(QResizeEvent *event)
+{
+    TimedGraphicsView::resizeEvent(event);
+    if (!engine) return;
+
+    // Keep the ring filling the view height, preserving any horizontal zoom
+    const QRectF bounds = sceneRect();
+    const qreal sy = viewport()->height() / bounds.height();
+    if (fitAll) {
+        const qreal s = qMin(sy, viewport()->width() / bounds.width());
+        setTransform(QTransform::fromScale(s, s));
+    } else {
+        const qreal zoom = transform().m11() / qMax(transform().m22(), 1e-9);
+        setTransform(QTransform::fromScale(sy * zoom, sy));
+    }
+    refresh();
+}
+
+void QueueRingView::scrollContentsBy(int dx, int dy)
+{
+    TimedGraphicsView::scrollContentsBy(dx, dy);
+    refresh();
+}
+
+void QueueRingView::wheelEvent(QWheelEvent *event)
+{
+    const int delta = event->angleDelta().y();
+    if (!(event->modifiers() & Qt::ControlModifier)) {
+        // Plain wheel scrolls along the ring
+        horizontalScrollBar()->setValue(horizontalScrollBar()->value() - delta);
+        event->accept();
+        return;
+    }
+
+    // Ctrl+wheel zooms horizontally between "whole ring" and large cells
+    const double minPixels = viewport()->width() / sceneRect().width() * PITCH;
+    const double current = pixelsPerSlot();
+    const double target = qBound(minPixels, current * (delta > 0 ? 1.25 : 0.8), MAX_PIXELS_PER_SLOT);
+    if (target != current && current > 0) {
+        fitAll = false;
+        scale(target / current, 1.0);
+    }
+    event->accept();
+    refresh();
+}
+
+QRectF QueueRingView::slotRect(int index) const
+{
+    return ringSlotRect(index);
+}
+
+double QueueRingView::pixelsPerSlot() const
+{
+    return transform().m11() * PITCH;
+}
+
+void QueueRingView::visibleSlots(int &first, int &last) const
+{
+    const QRectF visible = mapToScene(viewport()->rect()).boundingRect();
+    first = qMax(0, int(std::floor((visible.left() - BASE_X) / PITCH)));
+    last = qMin(layoutCapacity - 1, int(std::floor((visible.right() - BASE_X) / PITCH)));
+}
+
+void QueueRingView::showBands(int first, int last)
+{
+    if (last < first) {
+        hideBands();
+        return;
+    }
+
+    auto span = [](int from, int to) {
+        return QRectF(BASE_X + from * PITCH, BASE_Y, (to - from + 1) * PITCH - SPACING, BOX_HEIGHT);
+    };
+    emptyBand->setRect(span(first, last));
+    emptyBand->setVisible(true);
+
+    // The occupied part of a ring is at most two contiguous runs
+    const int capacity = engine->capacity();
+    const int head = engine->isEmpty() ? 0 : engine->frontIndex();
+    const int end = head + engine->size();
+    const int runs[2][2] = {
+        { head, qMin(end, capacity) - 1 },
+        { 0, end - capacity - 1 },
+    };
+    for (int r = 0; r < 2; r++) {
+        const int from = qMax(runs[r][0], first);
+        const int to = qMin(runs[r][1], last);
+        occupiedBands[r]->setVisible(from <= to);
+        if (from <= to) {
+            occupiedBands[r]->setRect(span(from, to));
+        }
+    }
+}
+
+void QueueRingView::hideBands()
+{
+    emptyBand->setVisible(false);
+    occupiedBands[0]->setVisible(false);
+    occupiedBands[1]->setVisible(false);
+}
+
+void QueueRingView::placeLabel(QGraphicsSimpleTextItem *label, int slot, qreal y)
+{
+    centerText(label, QPointF(slotRect(slot).center().x(), y));
+}
@@ -0,0 +1,71 @@
+#ifndef QUEUERINGVIEW_H
+#define QUEUERINGVIEW_H
+
+#include "perfhud.h"
+#include <QFont>
+
+class QueueEngine;
+class SceneAnimator;
+class QGraphicsRectItem;
+class QGraphicsSimpleTextItem;
+
+// Virtualized view of the queue ring. A single RingItem paints the slots
+// inside the viewport, so the cost of a refresh depends on neither the queue
+// capacity nor the screen size, and a repaint is a few batched draw calls.
+// Zoomed out, occupancy is drawn as collapsed bands instead of cells.
+class QueueRingView : public TimedGraphicsView
+{
+    Q_OBJECT
+
+public:
+    explicit QueueRingView(QGraphicsScene *scene, QWidget *parent = nullptr);
+
+    void setEngine(const QueueEngine *engine);
+    // Re-syncs the visible slots with the engine
+    void refresh();
+    // Rebuilds the scene extent after a capacity change
+    void relayout();
+    // Slides the new value into slot; a no-op when its text is not shown
+    void animateEnqueue(int slot);
+    // Fades a copy of value out of slot
+    void animateDequeue(int slot, int value);
+
+protected:
+    void resizeEvent(QResizeEvent *event) override;
+    void scrollContentsBy(int dx, int dy) override;
+    void wheelEvent(QWheelEvent *event) override;
+
+private:
+    class RingItem;
+
+    const QueueEngine *engine;
+    RingItem *ring;
+    // Background band plus up to two occupied runs of the ring
+    QGraphicsRectItem *emptyBand;
+    QGraphicsRectItem *occupiedBands[2];
+    QGraphicsRectItem *frame;
+    QGraphicsSimpleTextItem *frontLabel;
+    QGraphicsSimpleTextItem *rearLabel;
+    // Stand-ins for an enqueued value while it slides in, and a dequeued
+    // value while it fades out; the ring skips arrivingSlot meanwhile
+    QGraphicsSimpleTextItem *arrivingText;
+    QGraphicsSimpleTextItem *departingText;
+    int arrivingSlot;
+    int arrivingValue;
+    SceneAnimator *animator;
+    QFont indexFont;
+    QFont valueFont;
+    int layoutCapacity;
+    bool fitAll;
+
+    QRectF slotRect(int index) const;
+    double pixelsPerSlot() const;
+    void visibleSlots(int &first, int &last) const;
+    void settleArrival();
+    void showBands(int first, int last);
+    void hideBands();
+    void placeLabel(QGraphicsSimpleTextItem *label, int slot, qreal y);
+    bool isTextShown(int slot) const;
+};
+
+#endif // QUEUERINGVIEW_H
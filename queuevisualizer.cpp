@@ -1,4 +1,5 @@
 #include "queuevisualizer.h"
+#include "traceevents.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGraphicsRectItem>
@@ -9,23 +10,23 @@
 #include <QLineEdit>
 #include <QLabel>
 #include <QGroupBox>
-#include <QListWidget>
+#include <QListView>
+#include <QSpinBox>
+#include <QLocale>
+#include <QSignalBlocker>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QTimer>
 
 QueueVisualizer::QueueVisualizer(QWidget *parent)
     : QWidget(parent)
-    , frontIndex(-1)
-    , rearIndex(-1)
-    , size(0)
-    , isAnimating(false)
-    , animationStep(0)
-    , currentHistoryIndex(-1)
+    , previousFront(-1)
+    , lastSample{}
+    , smoothedRate(0.0)
+    , historyBeforeReplay(true)
 {
     setupUI();
 
-    // Setup animation timer
-    animationTimer = new QTimer(this);
-    connect(animationTimer, &QTimer::timeout, this, &QueueVisualizer::animateOperation);
-
     // Connect signals
     connect(enqueueButton, &QPushButton::clicked, this, [this]() {
         bool ok;
@@ -65,6 +66,45 @@ QueueVisualizer::QueueVisualizer(QWidget *parent)
     connect(clearButton, &QPushButton::clicked, this, &QueueVisualizer::clear);
     connect(undoButton, &QPushButton::clicked, this, &QueueVisualizer::undoOperation);
     connect(redoButton, &QPushButton::clicked, this, &QueueVisualizer::redoOperation);
+    connect(recordButton, &QPushButton::clicked, this, &QueueVisualizer::toggleRecording);
+    connect(historyView, &QListView::clicked, this, [this](const QModelIndex &index) {
+        engine.seek(historyModel->absoluteIndex(index.row()));
+    });
+    connect(historyModel, &HistoryModel::synchronized, this, &QueueVisualizer::selectHistoryRow);
+    connect(historyBudgetSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int megabytes) {
+        engine.setHistoryBudget(std::size_t(megabytes) * 1024 * 1024);
+        historyModel->scheduleSync(engine.history().endIndex());
+        updateCapacityIndicator();
+    });
+
+    connect(capacitySpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        if (!engine.setCapacity(value)) {
+            setStatusMessage("Capacity cannot be below the current size");
+            capacitySpinBox->setValue(engine.capacity());
+            return;
+        }
+        // Resizing linearizes the ring, which moves the front to slot 0
+        previousFront = engine.frontIndex();
+        view->relayout();
+        updateCapacityIndicator();
+        updateButtons();
+    });
+
+    connect(spscButton, &QPushButton::clicked, this, &QueueVisualizer::toggleSpscMode);
+    sampleTimer = new QTimer(this);
+    sampleTimer->setTimerType(Qt::PreciseTimer);
+    connect(sampleTimer, &QTimer::timeout, this, &QueueVisualizer::sampleSpsc);
+
+    traceReplayPanel->setHandlers(
+        [this](const OperationTrace &trace) { beginReplay(trace); },
+        [this](OperationTrace &trace, const QElapsedTimer &clock, qint64 deadlineNs) {
+            return replayFrame(trace, clock, deadlineNs);
+        },
+        [this]() { syncAfterReplay(); },
+        [this]() { endReplay(); });
+
+    // The engine drives every view update from here on
+    engine.setObserver(this);
 
     // Initialize
     updateVisualization();
@@ -73,238 +113,177 @@ QueueVisualizer::QueueVisualizer(QWidget *parent)
 
 QueueVisualizer::~QueueVisualizer()
 {
+    engine.setObserver(nullptr);
     delete scene;
 }
 
 bool QueueVisualizer::enqueue(int value)
 {
-    if (isFull()) {
-        setStatusMessage("Queue Overflow!");
-        return false;
-    }
-
-    addToHistory(Operation::ENQUEUE, value);
-
-    if (isEmpty()) {
-        frontIndex = 0;
-        rearIndex = 0;
-    } else {
-        rearIndex = (rearIndex + 1) % MAX_SIZE;
-    }
-    
-    arr[rearIndex] = value;
-    size++;
-    
-    updateVisualization();
-    setStatusMessage(QString("Enqueued value: %1").arg(value));
-    
-    // Start animation after updating
-    if (!isAnimating) {
-        animationStep = 0;
-        isAnimating = true;
-        animationTimer->start(100);
-    }
-    
-    emit stateChanged();
-    updateButtons();
-    return true;
+    return engine.enqueue(value);
 }
 
 int QueueVisualizer::dequeue()
 {
-    if (isEmpty()) {
-        setStatusMessage("Queue Underflow!");
-        return -1;
-    }
-
-    int value = arr[frontIndex];
-    addToHistory(Operation::DEQUEUE, value);
-    
-    if (frontIndex == rearIndex) {
-        // Last element being removed
-        frontIndex = -1;
-        rearIndex = -1;
-        size = 0;
-    } else {
-        frontIndex = (frontIndex + 1) % MAX_SIZE;
-        size--;
-    }
-    
-    updateVisualization();
-    setStatusMessage(QString("Dequeued value: %1").arg(value));
-    
-    // Start animation after updating
-    if (!isAnimating) {
-        animationStep = 0;
-        isAnimating = true;
-        animationTimer->start(100);
-    }
-    
-    emit stateChanged();
-    updateButtons();
-    return value;
+    return engine.dequeue();
 }
 
 int QueueVisualizer::front() const
 {
-    if (isEmpty()) {
-        return -1;
-    }
-    return arr[frontIndex];
+    return engine.front();
 }
 
 int QueueVisualizer::rear() const
 {
-    if (isEmpty()) {
-        return -1;
-    }
-    return arr[rearIndex];
+    return engine.rear();
 }
 
 void QueueVisualizer::clear()
 {
-    if (!isEmpty()) {
-        addToHistory(Operation::CLEAR, 0);
-        frontIndex = -1;
-        rearIndex = -1;
-        size = 0;
-        updateVisualization();
-        setStatusMessage("Queue cleared");
-        emit stateChanged();
-        updateButtons();
-    }
+    engine.clear();
 }
 
 bool QueueVisualizer::isEmpty() const
 {
-    return size == 0;
+    return engine.isEmpty();
 }
 
 bool QueueVisualizer::isFull() const
 {
-    return size == MAX_SIZE;
+    return engine.isFull();
 }
 
-void QueueVisualizer::updateVisualization()
+void QueueVisualizer::engineChanged(const EngineEvent &event)
 {
-    scene->clear();
-
-    const int BOX_WIDTH = 60;
-    const int BOX_HEIGHT = 40;
-    const int SPACING = 15;  // Increased spacing between boxes
-    const int BASE_Y = 120;  // Moved boxes down a bit
-    const int BASE_X = 50;
-    const int FRAME_PADDING = 15;  // Padding around the frame
-
-    // Draw queue frame
-    QPen framePen(Qt::black, 2);
-    scene->addLine(BASE_X - FRAME_PADDING, BASE_Y - FRAME_PADDING, 
-                  BASE_X + (MAX_SIZE * (BOX_WIDTH + SPACING)) - SPACING + FRAME_PADDING, BASE_Y - FRAME_PADDING, 
-                  framePen);
-    scene->addLine(BASE_X - FRAME_PADDING, BASE_Y + BOX_HEIGHT + FRAME_PADDING, 
-                  BASE_X + (MAX_SIZE * (BOX_WIDTH + SPACING)) - SPACING + FRAME_PADDING, BASE_Y + BOX_HEIGHT + FRAME_PADDING, 
-                  framePen);
-
-    // Draw vertical lines
-    scene->addLine(BASE_X - FRAME_PADDING, BASE_Y - FRAME_PADDING,
-                  BASE_X - FRAME_PADDING, BASE_Y + BOX_HEIGHT + FRAME_PADDING,
-                  framePen);
-    scene->addLine(BASE_X + (MAX_SIZE * (BOX_WIDTH + SPACING)) - SPACING + FRAME_PADDING, BASE_Y - FRAME_PADDING,
-                  BASE_X + (MAX_SIZE * (BOX_WIDTH + SPACING)) - SPACING + FRAME_PADDING, BASE_Y + BOX_HEIGHT + FRAME_PADDING,
-                  framePen);
-
-    // Draw all boxes
-    for (int i = 0; i < MAX_SIZE; i++) {
-        QString color = "#f0f0f0"; // Default empty color
-        int value = 0;
-        bool isOccupied = false;
+    if (recorder.isOpen()) {
+        recorder.record(event.type, event.op.type,
+                        event.type == EngineEvent::Jumped ? engine.history().currentIndex() : event.op.value);
+    }
 
-        if (!isEmpty()) {
-            // Check if this position is occupied in the circular queue
-            int relativePos = i - frontIndex;
-            if (relativePos < 0) relativePos += MAX_SIZE;
-            
-            if (frontIndex <= rearIndex) {
-                isOccupied = (i >= frontIndex && i <= rearIndex);
-            } else {
-                isOccupied = (i >= frontIndex || i <= rearIndex);
-            }
+    switch (event.type) {
+        case EngineEvent::Overflow:
+            setStatusMessage("Queue Overflow!");
+            return;
+        case EngineEvent::Underflow:
+            setStatusMessage("Queue Underflow!");
+            return;
+        case EngineEvent::Inserted:
+            syncHistoryList();
+            setStatusMessage(QString("Enqueued value: %1").arg(event.op.value));
+            break;
+        case EngineEvent::Removed:
+            syncHistoryList();
+            setStatusMessage(QString("Dequeued value: %1").arg(event.op.value));
+            break;
+        case EngineEvent::Cleared:
+            syncHistoryList();
+            setStatusMessage("Queue cleared");
+            break;
+        case EngineEvent::Undone:
+            selectHistoryRow();
+            setStatusMessage("Undo: " + historyModel->label(event.op));
+            break;
+        case EngineEvent::Redone:
+            selectHistoryRow();
+            setStatusMessage("Redo: " + historyModel->label(event.op));
+            break;
+        case EngineEvent::Jumped:
+            selectHistoryRow();
+            setStatusMessage(QString("Jumped to history step %1").arg(engine.history().currentIndex() + 1));
+            break;
+    }
 
-            if (isOccupied) {
-                color = "#81C784"; // Green for occupied
-                value = arr[i];
-            }
-        }
+    perfHud->addOperations(1);
+    if (capacitySpinBox->value() != engine.capacity()) {
+        // Undo, redo and seeks grow the ring back when history needs more room
+        const QSignalBlocker blocker(capacitySpinBox);
+        capacitySpinBox->setMaximum(qMax(capacitySpinBox->maximum(), engine.capacity()));
+        capacitySpinBox->setValue(engine.capacity());
+        updateCapacityIndicator();
+    }
+    updateVisualization();
 
-        // Draw box with appropriate color and value
-        QGraphicsRectItem *box = scene->addRect(
-            BASE_X + i * (BOX_WIDTH + SPACING),
-            BASE_Y,
-            BOX_WIDTH,
-            BOX_HEIGHT
-        );
-        box->setBrush(QColor(color));
-        box->setPen(QPen(Qt::black));
-
-        // Add index number above box
-        QGraphicsTextItem *indexText = scene->addText(QString::number(i));
-        QFont indexFont = indexText->font();
-        indexFont.setPointSize(10);
-        indexText->setFont(indexFont);
-        indexText->setDefaultTextColor(Qt::darkGray);
-        indexText->setPos(
-            BASE_X + i * (BOX_WIDTH + SPACING) + (BOX_WIDTH - indexText->boundingRect().width()) / 2,
-            BASE_Y - 35  // Moved index numbers up by 5 more pixels
-        );
-
-        if (isOccupied) {
-            QGraphicsTextItem *valueText = scene->addText(QString::number(value));
-            QFont valueFont = valueText->font();
-            valueFont.setPointSize(12);
-            valueText->setFont(valueFont);
-            valueText->setDefaultTextColor(Qt::black);
-            // Center the value in the box
-            valueText->setPos(
-                BASE_X + i * (BOX_WIDTH + SPACING) + (BOX_WIDTH - valueText->boundingRect().width()) / 2,
-                BASE_Y + (BOX_HEIGHT - valueText->boundingRect().height()) / 2
-            );
-        }
+    // Only the slot that changed is animated
+    if (event.type == EngineEvent::Inserted) {
+        view->animateEnqueue(engine.rearIndex());
+    } else if (event.type == EngineEvent::Removed && previousFront >= 0) {
+        view->animateDequeue(previousFront, event.op.value);
+    }
+    previousFront = engine.frontIndex();
 
-        // Add Front/Rear indicators
-        if (!isEmpty()) {
-            if (i == frontIndex) {
-                QGraphicsTextItem *frontText = scene->addText("Front");
-                QFont frontFont = frontText->font();
-                frontFont.setPointSize(10);
-                frontText->setFont(frontFont);
-                frontText->setDefaultTextColor(Qt::blue);
-                frontText->setPos(
-                    BASE_X + i * (BOX_WIDTH + SPACING) + (BOX_WIDTH - frontText->boundingRect().width()) / 2,
-                    BASE_Y - 55  // Moved up to avoid overlap
-                );
-            }
-            if (i == rearIndex) {
-                QGraphicsTextItem *rearText = scene->addText("Rear");
-                QFont rearFont = rearText->font();
-                rearFont.setPointSize(10);
-                rearText->setFont(rearFont);
-                rearText->setDefaultTextColor(Qt::red);
-                rearText->setPos(
-                    BASE_X + i * (BOX_WIDTH + SPACING) + (BOX_WIDTH - rearText->boundingRect().width()) / 2,
-                    BASE_Y + BOX_HEIGHT + 20
-                );
+    emit stateChanged();
+    updateButtons();
+}
+
+void QueueVisualizer::beginReplay(const OperationTrace &trace)
+{
+    engine.clear();
+    engine.clearHistory();
+    if (engine.capacity() < trace.peakSize()) {
+        capacitySpinBox->setValue(qMin(trace.peakSize(), capacitySpinBox->maximum()));
+    }
+    // Recording millions of replayed operations would only evict the budget
+    historyBeforeReplay = engine.isHistoryEnabled();
+    recordButton->setEnabled(false);
+    engine.setHistoryEnabled(false);
+    historyModel->reset();
+}
+
+long long QueueVisualizer::replayFrame(OperationTrace &trace, const QElapsedTimer &clock, qint64 deadlineNs)
+{
+    // Replay with the observer detached; syncAfterReplay() re-syncs only the
+    // visible ring slots once per frame
+    const int CHUNK = 4096;
+    engine.setObserver(nullptr);
+    long long applied = 0;
+    Operation op;
+    bool more = true;
+    while (more && clock.nsecsElapsed() < deadlineNs) {
+        for (int n = 0; n < CHUNK && (more = trace.next(op)); n++) {
+            switch (op.type) {
+                case Operation::Insert:
+                    engine.enqueue(op.value);
+                    break;
+                case Operation::Remove:
+                    engine.dequeue();
+                    break;
+                case Operation::Clear:
+                    engine.clear();
+                    break;
             }
+            applied++;
         }
     }
+    engine.setObserver(this);
+    perfHud->addOperations(applied);
+    previousFront = engine.frontIndex();
+    return applied;
+}
+
+void QueueVisualizer::syncAfterReplay()
+{
+    updateVisualization();
+    updateButtons();
+}
+
+void QueueVisualizer::endReplay()
+{
+    engine.setHistoryEnabled(historyBeforeReplay);
+    recordButton->setEnabled(true);
+    historyModel->reset();
+    setStatusMessage(QString("Trace replay finished with %1 elements in the queue").arg(engine.size()));
+    emit stateChanged();
+}
+
+void QueueVisualizer::updateVisualization()
+{
+    DSV_TRACE_SCOPE("QueueVisualizer::updateVisualization");
+    PerfHud::UpdateScope timing(perfHud);
 
     // Update capacity indicator
     updateCapacityIndicator();
 
-    // Adjust view
-    QRectF bounds = scene->itemsBoundingRect();
-    bounds.adjust(-20, -20, 20, 20);
-    view->setSceneRect(bounds);
-    view->fitInView(bounds, Qt::KeepAspectRatio);
+    // Only the slots inside the viewport are re-synced
+    view->refresh();
 }
 
 void QueueVisualizer::setupUI()
@@ -315,9 +294,12 @@ void QueueVisualizer::setupUI()
     QGroupBox *visualizationGroup = new QGroupBox("Queue Visualization");
     QVBoxLayout *visualizationLayout = new QVBoxLayout;
     scene = new QGraphicsScene(this);
-    view = new QGraphicsView(scene);
+    view = new QueueRingView(scene);
+    view->setEngine(&engine);
     view->setMinimumHeight(200);
     view->setRenderHint(QPainter::Antialiasing);
+    perfHud = new PerfHud("Queue", view);
+    perfHud->setHistoryBytesSource([this]() { return qint64(engine.history().memoryUsage()); });
     visualizationLayout->addWidget(view);
     visualizationGroup->setLayout(visualizationLayout);
     mainLayout->addWidget(visualizationGroup);
@@ -342,20 +324,67 @@ void QueueVisualizer::setupUI()
     controlsLayout->addWidget(rearButton);
     controlsLayout->addWidget(clearButton);
 
+    capacitySpinBox = new QSpinBox;
+    capacitySpinBox->setPrefix("Capacity: ");
+    capacitySpinBox->setRange(1, 10000000);
+    capacitySpinBox->setValue(engine.capacity());
+    capacitySpinBox->setToolTip("Number of ring slots; Ctrl+wheel zooms the view");
+    controlsLayout->addWidget(capacitySpinBox);
+
     controlsGroup->setLayout(controlsLayout);
     mainLayout->addWidget(controlsGroup);
 
+    // Create threaded mode group
+    QGroupBox *spscGroup = new QGroupBox("Threaded SPSC Mode");
+    QHBoxLayout *spscLayout = new QHBoxLayout;
+    spscCapacitySpinBox = new QSpinBox;
+    spscCapacitySpinBox->setPrefix("Ring: ");
+    spscCapacitySpinBox->setRange(2, 1 << 24);
+    spscCapacitySpinBox->setValue(1024);
+    spscCapacitySpinBox->setToolTip("Ring slots, rounded up to a power of two");
+    spscButton = new QPushButton("Start Threads");
+    spscButton->setToolTip("A producer thread enqueues into a lock-free ring while a consumer thread dequeues");
+    spscOccupancyBar = new QProgressBar;
+    spscOccupancyBar->setRange(0, 1000);
+    spscOccupancyBar->setValue(0);
+    spscOccupancyBar->setFormat("Occupancy: %p%");
+    spscLabel = new QLabel("Stopped");
+    spscLayout->addWidget(spscCapacitySpinBox);
+    spscLayout->addWidget(spscButton);
+    spscLayout->addWidget(spscOccupancyBar);
+    spscLayout->addWidget(spscLabel, 1);
+    spscGroup->setLayout(spscLayout);
+    mainLayout->addWidget(spscGroup);
+
+    // Create trace replay group
+    traceReplayPanel = new TraceReplayPanel;
+    mainLayout->addWidget(traceReplayPanel);
+
     // Create history group
     QGroupBox *historyGroup = new QGroupBox("Operation History");
     QVBoxLayout *historyLayout = new QVBoxLayout;
-    historyList = new QListWidget;
-    historyLayout->addWidget(historyList);
+    historyModel = new HistoryModel(&engine.history(), "Enqueue", "Dequeue", this);
+    historyView = new QListView;
+    historyView->setModel(historyModel);
+    historyView->setUniformItemSizes(true);
+    historyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    historyLayout->addWidget(historyView);
 
     QHBoxLayout *historyButtonLayout = new QHBoxLayout;
     undoButton = new QPushButton("Undo");
     redoButton = new QPushButton("Redo");
+    recordButton = new QPushButton("Record Session...");
+    recordButton->setToolTip("Log every operation to a binary session file for later replay");
+    historyBudgetSpinBox = new QSpinBox;
+    historyBudgetSpinBox->setPrefix("Budget: ");
+    historyBudgetSpinBox->setSuffix(" MB");
+    historyBudgetSpinBox->setRange(1, 4096);
+    historyBudgetSpinBox->setValue(int(engine.history().memoryBudget() / (1024 * 1024)));
+    historyBudgetSpinBox->setToolTip("Oldest operations are forgotten once the history exceeds this size");
     historyButtonLayout->addWidget(undoButton);
     historyButtonLayout->addWidget(redoButton);
+    historyButtonLayout->addWidget(recordButton);
+    historyButtonLayout->addWidget(historyBudgetSpinBox);
     historyLayout->addLayout(historyButtonLayout);
 
     historyGroup->setLayout(historyLayout);
@@ -381,7 +410,57 @@ void QueueVisualizer::updateCapacityIndicator()
 {
     QString style = isEmpty() ? "color: red;" : (isFull() ? "color: orange;" : "color: green;");
     statusLabel->setStyleSheet(style);
-    statusLabel->setText(QString("Size: %1/%2").arg(size).arg(MAX_SIZE));
+    statusLabel->setText(QString("Size: %1/%2 - History: %3")
+                             .arg(engine.size())
+                             .arg(engine.capacity())
+                             .arg(QLocale().formattedDataSize(qint64(engine.history().memoryUsage()))));
+}
+
+void QueueVisualizer::toggleSpscMode()
+{
+    if (pipeline.isRunning()) {
+        sampleTimer->stop();
+        pipeline.stop();
+        sampleSpsc();
+        spscButton->setText("Start Threads");
+        spscCapacitySpinBox->setEnabled(true);
+        return;
+    }
+
+    pipeline.start(std::size_t(spscCapacitySpinBox->value()));
+    lastSample = pipeline.snapshot();
+    smoothedRate = 0.0;
+    sampleClock.start();
+    sampleTimer->start(16);
+    spscButton->setText("Stop Threads");
+    spscCapacitySpinBox->setEnabled(false);
+}
+
+void QueueVisualizer::sampleSpsc()
+{
+    const SpscPipeline::Snapshot sample = pipeline.snapshot();
+    const qint64 elapsed = sampleClock.restart();
+    if (pipeline.isRunning() && elapsed > 0) {
+        const double rate = (sample.head - lastSample.head) * 1000.0 / elapsed;
+        smoothedRate = smoothedRate == 0.0 ? rate : 0.8 * smoothedRate + 0.2 * rate;
+    } else {
+        smoothedRate = 0.0;
+    }
+    lastSample = sample;
+
+    // head is read first, so tail - head never underflows
+    const std::uint64_t occupied = sample.tail - sample.head;
+    const std::uint64_t mask = sample.capacity - 1;
+    spscOccupancyBar->setValue(sample.capacity ? int(occupied * 1000 / sample.capacity) : 0);
+    spscLabel->setText(QString("%1 - %2 items/s - Front slot %3, Rear slot %4 - "
+                               "Stalls: producer %5, consumer %6 - Order errors: %7")
+                           .arg(pipeline.isRunning() ? "Running" : "Stopped")
+                           .arg(QLocale().toString(smoothedRate, 'f', 0))
+                           .arg(sample.head & mask)
+                           .arg(sample.tail & mask)
+                           .arg(sample.producerStalls)
+                           .arg(sample.consumerStalls)
+                           .arg(sample.orderErrors));
 }
 
 void QueueVisualizer::updateButtons()
@@ -391,145 +470,87 @@ void QueueVisualizer::updateButtons()
     frontButton->setEnabled(!isEmpty());
     rearButton->setEnabled(!isEmpty());
     clearButton->setEnabled(!isEmpty());
-    undoButton->setEnabled(currentHistoryIndex >= 0);
-    redoButton->setEnabled(currentHistoryIndex < history.size() - 1);
+    undoButton->setEnabled(engine.history().canUndo());
+    redoButton->setEnabled(engine.history().canRedo());
 }
 
-void QueueVisualizer::addToHistory(Operation::Type type, int value)
+void QueueVisualizer::syncHistoryList()
 {
-    // Remove any operations after current index if we're in the middle of history
-    while (history.size() > currentHistoryIndex + 1) {
-        history.removeLast();
-    }
+    if (!engine.isHistoryEnabled()) return;
 
-    Operation op;
-    op.type = type;
-    op.value = value;
-    op.prevState = getCurrentState();
-    history.append(op);
-    currentHistoryIndex++;
-
-    // Update history list widget
-    QString operationText;
-    switch (type) {
-        case Operation::ENQUEUE:
-            operationText = QString("Enqueue %1").arg(value);
-            break;
-        case Operation::DEQUEUE:
-            operationText = QString("Dequeue %1").arg(value);
-            break;
-        case Operation::CLEAR:
-            operationText = "Clear";
-            break;
-    }
-    historyList->addItem(operationText);
-    historyList->setCurrentRow(currentHistoryIndex);
-    updateButtons();
+    // The new entry replaces any redo tail; rows are inserted once per frame
+    historyModel->scheduleSync(engine.history().currentIndex());
 }
 
-void QueueVisualizer::undoOperation()
+void QueueVisualizer::selectHistoryRow()
 {
-    if (currentHistoryIndex < 0 || isAnimating) return;
-
-    Operation &op = history[currentHistoryIndex];
-    switch (op.type) {
-        case Operation::ENQUEUE:
-            if (rearIndex == frontIndex) {
-                frontIndex = rearIndex = -1;
-            } else {
-                rearIndex = (rearIndex - 1 + MAX_SIZE) % MAX_SIZE;
-            }
-            size--;
-            break;
-        case Operation::DEQUEUE:
-            frontIndex = (frontIndex - 1 + MAX_SIZE) % MAX_SIZE;
-            arr[frontIndex] = op.value;
-            size++;
-            break;
-        case Operation::CLEAR:
-            for (int i = 0; i < op.prevState.size(); i++) {
-                arr[i] = op.prevState[i];
-            }
-            frontIndex = 0;
-            rearIndex = op.prevState.size() - 1;
-            size = op.prevState.size();
-            break;
+    const int row = historyModel->rowOf(engine.history().currentIndex());
+    const QModelIndex index = historyModel->index(row, 0);
+    historyView->setCurrentIndex(index);
+    if (index.isValid()) {
+        historyView->scrollTo(index);
     }
+}
 
-    currentHistoryIndex--;
-    historyList->setCurrentRow(currentHistoryIndex);
-    updateButtons();
-    updateVisualization();
-    setStatusMessage("Undo: " + historyList->item(currentHistoryIndex + 1)->text());
+bool QueueVisualizer::setCapacity(int capacity)
+{
+    capacitySpinBox->setValue(capacity);
+    return engine.capacity() == capacity;
 }
 
-void QueueVisualizer::redoOperation()
+void QueueVisualizer::setHistoryEnabled(bool enabled)
 {
-    if (currentHistoryIndex >= history.size() - 1 || isAnimating) return;
-
-    currentHistoryIndex++;
-    Operation &op = history[currentHistoryIndex];
-    switch (op.type) {
-        case Operation::ENQUEUE:
-            if (isEmpty()) {
-                frontIndex = rearIndex = 0;
-            } else {
-                rearIndex = (rearIndex + 1) % MAX_SIZE;
-            }
-            arr[rearIndex] = op.value;
-            size++;
-            break;
-        case Operation::DEQUEUE:
-            frontIndex = (frontIndex + 1) % MAX_SIZE;
-            size--;
-            if (size == 0) {
-                frontIndex = rearIndex = -1;
-            }
-            break;
-        case Operation::CLEAR:
-            frontIndex = rearIndex = -1;
-            size = 0;
-            break;
+    engine.setHistoryEnabled(enabled);
+}
+
+void QueueVisualizer::toggleRecording()
+{
+    std::string error;
+    if (recorder.isOpen()) {
+        const qint64 records = qint64(recorder.recordCount());
+        const qint64 bytes = qint64(recorder.bytesWritten());
+        recordButton->setText("Record Session...");
+        traceReplayPanel->setEnabled(true);
+        if (!recorder.close(&error)) {
+            setStatusMessage("Recording failed: " + QString::fromStdString(error));
+            return;
+        }
+        setStatusMessage(QString("Recorded %1 operations (%2)")
+                             .arg(QLocale().toString(records))
+                             .arg(QLocale().formattedDataSize(bytes)));
+        return;
     }
 
-    historyList->setCurrentRow(currentHistoryIndex);
-    updateButtons();
-    updateVisualization();
-    setStatusMessage("Redo: " + historyList->item(currentHistoryIndex)->text());
+    const QString path = QFileDialog::getSaveFileName(this, "Record Session", "queue-session.dsvlog",
+                                                      "Session logs (*.dsvlog)");
+    if (path.isEmpty()) return;
+    if (!recorder.open(path.toStdString(), SessionLog::Queue, &error)) {
+        setStatusMessage(QString::fromStdString(error));
+        return;
+    }
+    recordButton->setText("Stop Recording");
+    // Replays bypass the observer and the history, so they would be missing
+    // from the log
+    traceReplayPanel->setEnabled(false);
+    setStatusMessage("Recording to " + QFileInfo(path).fileName());
 }
 
-void QueueVisualizer::animateOperation()
+void QueueVisualizer::undoOperation()
 {
-    if (!isAnimating) return;
-
-    // Animation logic here
-    animationStep++;
-    if (animationStep >= 10) {
-        isAnimating = false;
-        animationTimer->stop();
-        animationStep = 0;
-    }
-    updateVisualization();
+    DSV_TRACE_SCOPE("QueueVisualizer::undoOperation");
+    engine.undo();
+}
+
+void QueueVisualizer::redoOperation()
+{
+    DSV_TRACE_SCOPE("QueueVisualizer::redoOperation");
+    engine.redo();
 }
 
 QVector<int> QueueVisualizer::getCurrentState() const
 {
-    QVector<int> state;
-    if (!isEmpty()) {
-        if (frontIndex <= rearIndex) {
-            for (int i = frontIndex; i <= rearIndex; i++) {
-                state.append(arr[i]);
-            }
-        } else {
-            for (int i = frontIndex; i < MAX_SIZE; i++) {
-                state.append(arr[i]);
-            }
-            for (int i = 0; i <= rearIndex; i++) {
-                state.append(arr[i]);
-            }
-        }
-    }
-    return state;
+    const std::vector<int> state = engine.getCurrentState();
+    return QVector<int>(state.begin(), state.end());
 }
 
 QString QueueVisualizer::getStatusMessage() const
@@ -537,6 +558,11 @@ QString QueueVisualizer::getStatusMessage() const
     return statusMessage;
 }
 
+QGraphicsScene *QueueVisualizer::graphicsScene() const
+{
+    return scene;
+}
+
 void QueueVisualizer::setStatusMessage(const QString &message)
 {
     statusMessage = message;
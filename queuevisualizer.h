@@ -4,17 +4,27 @@
 #include <QWidget>
 #include <QGraphicsScene>
 #include <QGraphicsView>
-#include <QTimer>
 #include <QStack>
 #include <QString>
-#include <QListWidget>
+#include <QListView>
 #include <QVector>
+#include "queueengine.h"
+#include "historymodel.h"
+#include "queueringview.h"
+#include "spscpipeline.h"
+#include "tracereplaypanel.h"
+#include "sessionlog.h"
+#include "perfhud.h"
+#include <QElapsedTimer>
 
 class QPushButton;
 class QLineEdit;
 class QLabel;
+class QSpinBox;
+class QProgressBar;
+class QTimer;
 
-class QueueVisualizer : public QWidget
+class QueueVisualizer : public QWidget, public EngineObserver
 {
     Q_OBJECT
 
@@ -31,39 +41,29 @@ public:
     void clear();
     QVector<int> getCurrentState() const;
     QString getStatusMessage() const;
+    QGraphicsScene *graphicsScene() const;
     void undoOperation();
     void redoOperation();
+    bool setCapacity(int capacity);
+    void setHistoryEnabled(bool enabled);
 
 signals:
     void statusChanged(const QString &message);
     void stateChanged();
 
-private:
-    // Constants
-    static const int MAX_SIZE = 5;
+protected:
+    void engineChanged(const EngineEvent &event) override;
 
+private:
     // Queue state
-    int arr[MAX_SIZE];
-    int frontIndex;
-    int rearIndex;
-    int size;
+    QueueEngine engine;
 
-    // Animation state
-    bool isAnimating;
-    int animationStep;
+    // Front slot as of the last notification, where a dequeue came from
+    int previousFront;
 
     // Status message
     QString statusMessage;
 
-    // Operation history
-    struct Operation {
-        enum Type { ENQUEUE, DEQUEUE, CLEAR } type;
-        int value;
-        QVector<int> prevState;
-    };
-    QVector<Operation> history;
-    int currentHistoryIndex;
-
     // UI Elements
     QLineEdit *inputField;
     QPushButton *enqueueButton;
@@ -73,22 +73,50 @@ private:
     QPushButton *clearButton;
     QPushButton *undoButton;
     QPushButton *redoButton;
+    QPushButton *recordButton;
+    QSpinBox *capacitySpinBox;
+    QSpinBox *historyBudgetSpinBox;
     QLabel *statusLabel;
-    QListWidget *historyList;
+    QListView *historyView;
+    HistoryModel *historyModel;
 
     // Graphics and timer
     QGraphicsScene *scene;
-    QGraphicsView *view;
-    QTimer *animationTimer;
+    QueueRingView *view;
+
+    // Threaded SPSC mode; the GUI only samples the ring once per frame
+    SpscPipeline pipeline;
+    SpscPipeline::Snapshot lastSample;
+    QElapsedTimer sampleClock;
+    double smoothedRate;
+    QTimer *sampleTimer;
+    QSpinBox *spscCapacitySpinBox;
+    QPushButton *spscButton;
+    QProgressBar *spscOccupancyBar;
+    QLabel *spscLabel;
+
+    TraceReplayPanel *traceReplayPanel;
+    bool historyBeforeReplay;
+
+    // Streams every notification to disk while recording
+    SessionWriter recorder;
+    PerfHud *perfHud;
 
     void setupUI();
     void updateVisualization();
     void setStatusMessage(const QString &message);
     void updateButtons();
-    void animateOperation();
-    void addToHistory(Operation::Type type, int value);
+    void syncHistoryList();
+    void selectHistoryRow();
     void drawBox(int index, int value, const QString &color = "white");
     void updateCapacityIndicator();
+    void toggleSpscMode();
+    void sampleSpsc();
+    void beginReplay(const OperationTrace &trace);
+    long long replayFrame(OperationTrace &trace, const QElapsedTimer &clock, qint64 deadlineNs);
+    void syncAfterReplay();
+    void endReplay();
+    void toggleRecording();
 };
 
 #endif // QUEUEVISUALIZER_H
@@ -0,0 +1,101 @@
+#include "sceneanimator.h"
+#include <QGraphicsItem>
+
+SceneAnimator::SceneAnimator(QObject *parent)
+    : QAbstractAnimation(parent)
+    , easing(QEasingCurve::OutCubic)
+{
+}
+
+int SceneAnimator::duration() const
+{
+    // Runs until the last track finishes
+    return -1;
+}
+
+void SceneAnimator::animatePos(QGraphicsItem *item, const QPointF &from, const QPointF &to, int msecs)
+{
+    addTrack(Track{item, false, from, to, 0, msecs, false});
+}
+
+void SceneAnimator::animateOpacity(QGraphicsItem *item, qreal from, qreal to, int msecs, bool hideAtEnd)
+{
+    addTrack(Track{item, true, QPointF(from, 0), QPointF(to, 0), 0, msecs, hideAtEnd});
+}
+
+void SceneAnimator::finish(QGraphicsItem *item)
+{
+    for (int i = tracks.size() - 1; i >= 0; i--) {
+        if (tracks[i].item == item) {
+            applyTrack(tracks[i], 1.0);
+            tracks.remove(i);
+        }
+    }
+}
+
+void SceneAnimator::finishAll()
+{
+    for (const Track &track : tracks) {
+        applyTrack(track, 1.0);
+    }
+    tracks.clear();
+    stop();
+}
+
+int SceneAnimator::activeCount() const
+{
+    return tracks.size();
+}
+
+void SceneAnimator::addTrack(const Track &track)
+{
+    // A newer animation of the same property takes over from the current value
+    for (int i = 0; i < tracks.size(); i++) {
+        if (tracks[i].item == track.item && tracks[i].opacity == track.opacity) {
+            tracks.remove(i);
+            break;
+        }
+    }
+
+    // Starting the clock ticks it once at time 0, so the track goes in first
+    Track added = track;
+    added.start = state() == Running ? currentTime() : 0;
+    tracks.append(added);
+    applyTrack(added, 0.0);
+    if (state() != Running) {
+        start();
+    }
+}
+
+void SceneAnimator::updateCurrentTime(int currentTime)
+{
+    for (int i = 0; i < tracks.size();) {
+        const Track &track = tracks[i];
+        const qreal t = track.length > 0 ? qreal(currentTime - track.start) / track.length : 1.0;
+        if (t >= 1.0) {
+            applyTrack(track, 1.0);
+            tracks[i] = tracks.last();
+            tracks.removeLast();
+        } else {
+            applyTrack(track, easing.valueForProgress(qMax<qreal>(t, 0.0)));
+            i++;
+        }
+    }
+
+    if (tracks.isEmpty()) {
+        stop();
+    }
+}
+
+void SceneAnimator::applyTrack(const Track &track, qreal progress)
+{
+    const QPointF value = track.from + (track.to - track.from) * progress;
+    if (!track.opacity) {
+        track.item->setPos(value);
+    } else if (progress >= 1.0 && track.hideAtEnd) {
+        track.item->setVisible(false);
+        track.item->setOpacity(1.0);
+    } else {
+        track.item->setOpacity(value.x());
+    }
+}
@@ -0,0 +1,55 @@
+#ifndef SCENEANIMATOR_H
+#define SCENEANIMATOR_H
+
+#include <QAbstractAnimation>
+#include <QEasingCurve>
+#include <QPointF>
+#include <QVector>
+
+class QGraphicsItem;
+
+// Frame clock for scene item animations. It runs on Qt's unified animation
+// timer, which ticks in step with the display refresh. Each tick only
+// touches the items that are currently animating, and the clock stops
+// whenever nothing is moving.
+class SceneAnimator : public QAbstractAnimation
+{
+    Q_OBJECT
+
+public:
+    explicit SceneAnimator(QObject *parent = nullptr);
+
+    int duration() const override;
+
+    // Moves item from from to to; replaces any position animation of item
+    void animatePos(QGraphicsItem *item, const QPointF &from, const QPointF &to, int msecs);
+    // Fades item; with hideAtEnd the item is hidden and made opaque again
+    // once the fade completes
+    void animateOpacity(QGraphicsItem *item, qreal from, qreal to, int msecs, bool hideAtEnd = false);
+    // Drops the item's animations and snaps it to their end values
+    void finish(QGraphicsItem *item);
+    void finishAll();
+    int activeCount() const;
+
+protected:
+    void updateCurrentTime(int currentTime) override;
+
+private:
+    struct Track {
+        QGraphicsItem *item;
+        bool opacity;
+        QPointF from;
+        QPointF to;
+        int start;
+        int length;
+        bool hideAtEnd;
+    };
+
+    QVector<Track> tracks;
+    QEasingCurve easing;
+
+    void addTrack(const Track &track);
+    static void applyTrack(const Track &track, qreal progress);
+};
+
+#endif // SCENEANIMATOR_H
@@ -0,0 +1,50 @@
+#include "segmentedstack.h"
+#include <algorithm>
+
+SegmentedStack::SegmentedStack()
+    : count(0)
+{
+}
+
+void SegmentedStack::clear()
+{
+    count = 0;
+    if (chunks.size() > 1) {
+        chunks.resize(1);
+    }
+}
+
+void SegmentedStack::assign(const std::vector<int> &values)
+{
+    clear();
+    for (int value : values) {
+        push(value);
+    }
+}
+
+void SegmentedStack::copyTo(std::vector<int> &out) const
+{
+    out.resize(count);
+    int copied = 0;
+    for (std::size_t c = 0; copied < count; c++) {
+        int n = std::min(CHUNK_SIZE, count - copied);
+        std::copy(chunks[c].get(), chunks[c].get() + n, out.begin() + copied);
+        copied += n;
+    }
+}
+
+std::size_t SegmentedStack::allocatedBytes() const
+{
+    return chunks.size() * CHUNK_SIZE * sizeof(int)
+        + chunks.capacity() * sizeof(std::unique_ptr<int[]>);
+}
+
+std::size_t SegmentedStack::usedBytes() const
+{
+    return static_cast<std::size_t>(count) * sizeof(int);
+}
+
+void SegmentedStack::addChunk()
+{
+    chunks.emplace_back(new int[CHUNK_SIZE]);
+}
@@ -0,0 +1,58 @@
+#ifndef SEGMENTEDSTACK_H
+#define SEGMENTEDSTACK_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+// Stack storage made of fixed-size chunks. Growing allocates a new chunk and
+// never moves existing elements, so element addresses stay stable.
+class SegmentedStack
+{
+public:
+    static constexpr int CHUNK_SHIFT = 12;
+    static constexpr int CHUNK_SIZE = 1 << CHUNK_SHIFT;
+
+    SegmentedStack();
+
+    void push(int value)
+    {
+        if (count == static_cast<int>(chunks.size()) << CHUNK_SHIFT) {
+            addChunk();
+        }
+        chunks[count >> CHUNK_SHIFT][count & (CHUNK_SIZE - 1)] = value;
+        count++;
+    }
+
+    int pop()
+    {
+        count--;
+        int value = chunks[count >> CHUNK_SHIFT][count & (CHUNK_SIZE - 1)];
+        // Keep one spare chunk so push/pop at a boundary doesn't thrash
+        if (chunks.size() > 1 && count + 2 * CHUNK_SIZE <= static_cast<int>(chunks.size()) << CHUNK_SHIFT) {
+            chunks.pop_back();
+        }
+        return value;
+    }
+
+    int top() const { return at(count - 1); }
+    int at(int index) const { return chunks[index >> CHUNK_SHIFT][index & (CHUNK_SIZE - 1)]; }
+    int size() const { return count; }
+    bool isEmpty() const { return count == 0; }
+
+    // Drops all elements and releases every chunk but the first
+    void clear();
+    void assign(const std::vector<int> &values);
+    void copyTo(std::vector<int> &out) const;
+
+    std::size_t allocatedBytes() const;
+    std::size_t usedBytes() const;
+
+private:
+    std::vector<std::unique_ptr<int[]>> chunks;
+    int count;
+
+    void addChunk();
+};
+
+#endif // SEGMENTEDSTACK_H
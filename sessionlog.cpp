@@ -0,0 +1,289 @@
+#include "sessionlog.h"
+#include <cerrno>
+#include <cstring>
+
+namespace {
+
+const char HEADER_MAGIC[8] = {'D', 'S', 'V', 'S', 'E', 'S', 'S', '1'};
+const char TRAILER_MAGIC[8] = {'D', 'S', 'V', 'I', 'N', 'D', 'X', '1'};
+const std::size_t HEADER_BYTES = 16;
+const std::size_t TRAILER_BYTES = 40;
+const std::size_t INDEX_ENTRY_BYTES = 16;
+const std::size_t BUFFER_BYTES = 1 << 16;
+
+void putU32(unsigned char *p, std::uint32_t value)
+{
+    for (int i = 0; i < 4; i++) p[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+void putU64(unsigned char *p, std::uint64_t value)
+{
+    for (int i = 0; i < 8; i++) p[i] = static_cast<unsigned char>(value >> (8 * i));
+}
+
+std::uint32_t getU32(const unsigned char *p)
+{
+    std::uint32_t value = 0;
+    for (int i = 3; i >= 0; i--) value = (value << 8) | p[i];
+    return value;
+}
+
+std::uint64_t getU64(const unsigned char *p)
+{
+    std::uint64_t value = 0;
+    for (int i = 7; i >= 0; i--) value = (value << 8) | p[i];
+    return value;
+}
+
+// False on a truncated or overlong varint
+bool getVarint(const unsigned char *&p, const unsigned char *end, std::uint64_t &value)
+{
+    value = 0;
+    for (int shift = 0; shift < 64 && p < end; shift += 7) {
+        const unsigned char byte = *p++;
+        value |= std::uint64_t(byte & 0x7f) << shift;
+        if (!(byte & 0x80)) return true;
+    }
+    return false;
+}
+
+}
+
+SessionWriter::SessionWriter()
+    : file(nullptr)
+    , used(0)
+    , written(0)
+    , records(0)
+    , lastTimestamp(0)
+    , writeFailed(false)
+{
+}
+
+SessionWriter::~SessionWriter()
+{
+    close();
+}
+
+bool SessionWriter::open(const std::string &path, SessionLog::Structure structure, std::string *error)
+{
+    close();
+    file = std::fopen(path.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "Cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    buffer.assign(BUFFER_BYTES, 0);
+    std::memcpy(buffer.data(), HEADER_MAGIC, sizeof(HEADER_MAGIC));
+    putU32(buffer.data() + 8, SessionLog::VERSION);
+    putU32(buffer.data() + 12, structure);
+    used = HEADER_BYTES;
+    written = 0;
+    records = 0;
+    lastTimestamp = 0;
+    index.clear();
+    writeFailed = false;
+    started = std::chrono::steady_clock::now();
+    return true;
+}
+
+bool SessionWriter::close(std::string *error)
+{
+    if (!file) return true;
+
+    flush();
+    const std::uint64_t indexOffset = written;
+    std::vector<unsigned char> footer(index.size() * INDEX_ENTRY_BYTES + TRAILER_BYTES);
+    unsigned char *p = footer.data();
+    for (const IndexEntry &entry : index) {
+        putU64(p, entry.offset);
+        putU64(p + 8, entry.timestampNs);
+        p += INDEX_ENTRY_BYTES;
+    }
+    putU64(p, indexOffset);
+    putU64(p + 8, records);
+    putU64(p + 16, lastTimestamp);
+    putU32(p + 24, SessionLog::INDEX_INTERVAL);
+    putU32(p + 28, 0);
+    std::memcpy(p + 32, TRAILER_MAGIC, sizeof(TRAILER_MAGIC));
+    if (std::fwrite(footer.data(), 1, footer.size(), file) != footer.size()) {
+        writeFailed = true;
+    }
+    if (std::fclose(file) != 0) {
+        writeFailed = true;
+    }
+    file = nullptr;
+    buffer.clear();
+    buffer.shrink_to_fit();
+    index.clear();
+
+    if (writeFailed && error) {
+        *error = "Writing the session log failed";
+    }
+    return !writeFailed;
+}
+
+bool SessionWriter::isOpen() const
+{
+    return file != nullptr;
+}
+
+void SessionWriter::flush()
+{
+    if (used == 0) return;
+    if (std::fwrite(buffer.data(), 1, used, file) != used) {
+        writeFailed = true;
+    }
+    written += used;
+    used = 0;
+}
+
+SessionReader::SessionReader()
+    : base(nullptr)
+    , cursor(nullptr)
+    , recordsEnd(nullptr)
+    , indexData(nullptr)
+    , count(0)
+    , consumed(0)
+    , timestamp(0)
+    , duration(0)
+    , kind(SessionLog::Stack)
+{
+}
+
+bool SessionReader::open(const std::string &path, std::string *error)
+{
+    close();
+    if (!file.open(path, error)) {
+        return false;
+    }
+
+    const std::size_t size = file.size();
+    const unsigned char *data = reinterpret_cast<const unsigned char *>(file.data());
+    auto fail = [&](const char *message) {
+        if (error) *error = message;
+        close();
+        return false;
+    };
+    if (size < HEADER_BYTES + TRAILER_BYTES || std::memcmp(data, HEADER_MAGIC, sizeof(HEADER_MAGIC)) != 0) {
+        return fail("Not a session log");
+    }
+    if (getU32(data + 8) != SessionLog::VERSION) {
+        return fail("Unsupported session log version");
+    }
+    const std::uint32_t structure = getU32(data + 12);
+    if (structure > SessionLog::Queue) {
+        return fail("Unknown data structure in session log");
+    }
+
+    const unsigned char *trailer = data + size - TRAILER_BYTES;
+    if (std::memcmp(trailer + 32, TRAILER_MAGIC, sizeof(TRAILER_MAGIC)) != 0) {
+        return fail("Session log has no index footer; the recording was not stopped cleanly");
+    }
+    const std::uint64_t indexOffset = getU64(trailer);
+    const std::uint64_t records = getU64(trailer + 8);
+    const std::uint32_t interval = getU32(trailer + 24);
+    const std::uint64_t entries = interval ? (records + interval - 1) / interval : 0;
+    if (interval != SessionLog::INDEX_INTERVAL || indexOffset < HEADER_BYTES ||
+        indexOffset > size - TRAILER_BYTES ||
+        (size - TRAILER_BYTES - indexOffset) != entries * INDEX_ENTRY_BYTES) {
+        return fail("Session log index is corrupt");
+    }
+
+    base = data;
+    recordsEnd = data + indexOffset;
+    indexData = recordsEnd;
+    count = records;
+    duration = getU64(trailer + 16);
+    kind = SessionLog::Structure(structure);
+    for (std::uint64_t i = 0; i < entries; i++) {
+        const std::uint64_t offset = getU64(indexData + i * INDEX_ENTRY_BYTES);
+        if (offset < HEADER_BYTES || offset >= indexOffset) {
+            return fail("Session log index is corrupt");
+        }
+    }
+    seek(0);
+    return true;
+}
+
+void SessionReader::close()
+{
+    file.close();
+    base = cursor = recordsEnd = indexData = nullptr;
+    count = consumed = timestamp = duration = 0;
+    kind = SessionLog::Stack;
+}
+
+bool SessionReader::isOpen() const
+{
+    return file.isOpen();
+}
+
+SessionLog::Structure SessionReader::structure() const
+{
+    return kind;
+}
+
+std::uint64_t SessionReader::recordCount() const
+{
+    return count;
+}
+
+std::uint64_t SessionReader::position() const
+{
+    return consumed;
+}
+
+std::uint64_t SessionReader::durationNs() const
+{
+    return duration;
+}
+
+bool SessionReader::seek(std::uint64_t record)
+{
+    if (!base || record > count) return false;
+
+    if (record == count && count % SessionLog::INDEX_INTERVAL == 0) {
+        // Just past the last group; there is no index entry to start from
+        cursor = recordsEnd;
+        consumed = count;
+        timestamp = duration;
+        return true;
+    }
+
+    const std::uint64_t entry = record / SessionLog::INDEX_INTERVAL;
+    const unsigned char *p = indexData + entry * INDEX_ENTRY_BYTES;
+    cursor = base + getU64(p);
+    timestamp = getU64(p + 8);
+    consumed = entry * SessionLog::INDEX_INTERVAL;
+
+    SessionLog::Record skipped;
+    while (consumed < record) {
+        if (!next(skipped)) return false;
+    }
+    return true;
+}
+
+bool SessionReader::next(SessionLog::Record &record)
+{
+    if (consumed >= count || cursor >= recordsEnd) return false;
+
+    const unsigned char *p = cursor;
+    const unsigned char type = *p & 0x0f;
+    const unsigned char operation = *p++ >> 4;
+    std::uint64_t zigzag;
+    std::uint64_t delta;
+    if (type > EngineEvent::Underflow || operation > Operation::Clear || !getVarint(p, recordsEnd, zigzag) || !getVarint(p, recordsEnd, delta)) {
+        return false;
+    }
+
+    const std::uint32_t bits = std::uint32_t(zigzag);
+    timestamp += delta;
+    record.type = EngineEvent::Type(type);
+    record.operation = Operation::Type(operation);
+    record.value = int((bits >> 1) ^ (0u - (bits & 1)));
+    record.timestampNs = timestamp;
+    cursor = p;
+    consumed++;
+    return true;
+}
@@ -0,0 +1,147 @@
+#ifndef SESSIONLOG_H
+#define SESSIONLOG_H
+
+#include "engineobserver.h"
+#include "mappedfile.h"
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+// Binary log of every engine notification in a session, for replaying real
+// workloads later.
+//
+//     header   "DSVSESS1", u32 version, u32 structure
+//     record   u8 event type | operation << 4, zigzag varint value,
+//              varint ns since previous
+//     index    per INDEX_INTERVAL records: u64 byte offset, u64 timestamp ns
+//     trailer  u64 index offset, u64 record count, u64 last timestamp ns,
+//              u32 interval, u32 0, "DSVINDX1"
+//
+// Integers are little-endian. The operation is the one applied, undone or
+// redone, so an Undone record says whether a push or a pop was taken back.
+// The value is the operation value, or the history index for Jumped. A log without a trailer (recording not closed)
+// is rejected.
+namespace SessionLog {
+    enum Structure : std::uint32_t { Stack = 0, Queue = 1 };
+
+    const std::uint32_t VERSION = 2;
+    const std::uint32_t INDEX_INTERVAL = 512;
+
+    struct Record {
+        EngineEvent::Type type;
+        Operation::Type operation;
+        int value;
+        // Nanoseconds since recording started
+        std::uint64_t timestampNs;
+    };
+}
+
+// Appends records to an in-memory buffer and writes it out in large blocks,
+// so recording costs a clock read and a few byte stores per operation.
+class SessionWriter
+{
+public:
+    SessionWriter();
+    ~SessionWriter();
+
+    SessionWriter(const SessionWriter &) = delete;
+    SessionWriter &operator=(const SessionWriter &) = delete;
+
+    bool open(const std::string &path, SessionLog::Structure structure, std::string *error = nullptr);
+    // Writes the index footer; the log is only readable after this
+    bool close(std::string *error = nullptr);
+    bool isOpen() const;
+
+    void record(EngineEvent::Type type, Operation::Type operation, int value)
+    {
+        const std::uint64_t now = std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                                    std::chrono::steady_clock::now() - started).count());
+        if (records % SessionLog::INDEX_INTERVAL == 0) {
+            index.push_back(IndexEntry{written + used, lastTimestamp});
+        }
+        if (used + MAX_RECORD_BYTES > buffer.size()) {
+            flush();
+        }
+        unsigned char *p = buffer.data() + used;
+        *p++ = static_cast<unsigned char>(type | (operation << 4));
+        const std::uint32_t zigzag = (std::uint32_t(value) << 1) ^ std::uint32_t(value >> 31);
+        p = putVarint(p, zigzag);
+        p = putVarint(p, now - lastTimestamp);
+        used = std::size_t(p - buffer.data());
+        lastTimestamp = now;
+        records++;
+    }
+
+    std::uint64_t recordCount() const { return records; }
+    std::uint64_t bytesWritten() const { return written + used; }
+
+private:
+    struct IndexEntry {
+        // Start of the first record in the group and the time before it
+        std::uint64_t offset;
+        std::uint64_t timestampNs;
+    };
+
+    // Opcode, 5-byte value, 10-byte delta
+    static const std::size_t MAX_RECORD_BYTES = 16;
+
+    std::FILE *file;
+    std::vector<unsigned char> buffer;
+    std::size_t used;
+    std::uint64_t written;
+    std::uint64_t records;
+    std::uint64_t lastTimestamp;
+    std::chrono::steady_clock::time_point started;
+    std::vector<IndexEntry> index;
+    bool writeFailed;
+
+    void flush();
+
+    static unsigned char *putVarint(unsigned char *p, std::uint64_t value)
+    {
+        while (value >= 0x80) {
+            *p++ = static_cast<unsigned char>(value | 0x80);
+            value >>= 7;
+        }
+        *p++ = static_cast<unsigned char>(value);
+        return p;
+    }
+};
+
+// Reads a closed session log straight out of a memory mapping. seek() jumps
+// to the nearest indexed record and decodes forward from there.
+class SessionReader
+{
+public:
+    SessionReader();
+
+    bool open(const std::string &path, std::string *error = nullptr);
+    void close();
+    bool isOpen() const;
+
+    SessionLog::Structure structure() const;
+    std::uint64_t recordCount() const;
+    std::uint64_t position() const;
+    // Timestamp of the last record
+    std::uint64_t durationNs() const;
+
+    bool seek(std::uint64_t record);
+    // Next record, or false at the end of the log
+    bool next(SessionLog::Record &record);
+
+private:
+    MappedFile file;
+    const unsigned char *base;
+    const unsigned char *cursor;
+    const unsigned char *recordsEnd;
+    const unsigned char *indexData;
+    std::uint64_t count;
+    std::uint64_t consumed;
+    std::uint64_t timestamp;
+    std::uint64_t duration;
+    SessionLog::Structure kind;
+};
+
+#endif // SESSIONLOG_H
@@ -0,0 +1,411 @@
+#include "shuntingyard.h"
+#include "mappedfile.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <cstring>
+#include <iterator>
+#include <limits>
+#include <thread>
+
+namespace {
+
+const std::uint32_t NO_SPLIT = std::numeric_limits<std::uint32_t>::max();
+
+// Parenthesis depth and outermost operators of one block of the input,
+// relative to the depth at the block start
+struct BlockScan {
+    std::size_t begin = 0;
+    std::size_t end = 0;
+    int depthChange = 0;
+    // Lowest depth reached; the block's outermost tokens sit here
+    int minDepth = 0;
+    int minPrecedence = INT_MAX;
+    // Offset of the first binary operator at minDepth, per Operators::TABLE entry
+    std::uint32_t firstSplit[Operators::COUNT];
+};
+
+void scanBlock(std::string_view source, BlockScan &block)
+{
+    std::fill(std::begin(block.firstSplit), std::end(block.firstSplit), NO_SPLIT);
+    Tokenizer tokenizer(source, block.begin);
+    Token token;
+    int depth = 0;
+    while (tokenizer.next(token) && token.offset < block.end) {
+        if (token.kind == Token::LeftParen) {
+            depth++;
+        } else if (token.kind == Token::RightParen) {
+            if (--depth < block.minDepth) {
+                block.minDepth = depth;
+                block.minPrecedence = INT_MAX;
+                std::fill(std::begin(block.firstSplit), std::end(block.firstSplit), NO_SPLIT);
+            }
+        } else if (token.kind == Token::Operator && depth == block.minDepth) {
+            block.minPrecedence = std::min(block.minPrecedence, token.info().precedence);
+            if (!token.info().unary && block.firstSplit[token.op] == NO_SPLIT) {
+                block.firstSplit[token.op] = token.offset;
+            }
+        }
+    }
+    block.depthChange = depth;
+}
+
+// Runs work(0) .. work(count - 1) concurrently, the last on this thread
+template <typename Work>
+void runParallel(int count, const Work &work)
+{
+    std::vector<std::thread> threads;
+    threads.reserve(std::size_t(count - 1));
+    for (int i = 0; i + 1 < count; i++) {
+        threads.emplace_back([&work, i] { work(i); });
+    }
+    work(count - 1);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+}
+
+double ShuntingYard::FileStats::megabytesPerSecond() const
+{
+    return seconds > 0.0 ? double(inputBytes) / 1e6 / seconds : 0.0;
+}
+
+ShuntingYard::ShuntingYard()
+    : flushed(0)
+    , index(0)
+    , finished(false)
+{
+}
+
+void ShuntingYard::reset(const std::string &infix)
+{
+    this->infix = infix;
+    source = this->infix;
+    tokenList = Tokenizer::tokenize(source);
+    postfix.clear();
+    flushed = 0;
+    postfix.reserve(this->infix.size() + tokenList.size());
+    stack.clear();
+    index = 0;
+    finished = false;
+}
+
+ShuntingYard::Step ShuntingYard::step()
+{
+    if (index >= static_cast<int>(tokenList.size())) {
+        return finish();
+    }
+    return process(tokenList[index++]);
+}
+
+ShuntingYard::Step ShuntingYard::finish()
+{
+    // Pop all remaining operators from the stack
+    Step result{Step::Finished, Token{Token::Invalid, 0, std::uint32_t(source.size()), 0}, false};
+    while (!stack.empty()) {
+        const Token top = stack.back();
+        stack.pop_back();
+        result.token = top;
+        if (top.kind == Token::LeftParen) {
+            result.unmatchedParen = true;
+        } else {
+            emitOperator(top);
+        }
+    }
+    finished = true;
+    return result;
+}
+
+ShuntingYard::Step ShuntingYard::process(const Token &token)
+{
+    switch (token.kind) {
+        case Token::Number:
+        case Token::Identifier:
+            emit(token.text(source));
+            return Step{Step::Operand, token, false};
+        case Token::Function:
+            stack.push_back(token);
+            return Step{Step::Function, token, false};
+        case Token::LeftParen:
+            stack.push_back(token);
+            return Step{Step::OpenParen, token, false};
+        case Token::RightParen:
+        case Token::Comma: {
+            while (!stack.empty() && stack.back().kind != Token::LeftParen) {
+                emitOperator(stack.back());
+                stack.pop_back();
+            }
+            const bool matched = !stack.empty();
+            if (token.kind == Token::Comma) {
+                // The argument's parenthesis stays open
+                return Step{Step::Comma, token, !matched};
+            }
+            if (!matched) {
+                return Step{Step::UnmatchedClose, token, false};
+            }
+            stack.pop_back(); // Remove the '('
+            if (!stack.empty() && stack.back().kind == Token::Function) {
+                emitOperator(stack.back());
+                stack.pop_back();
+            }
+            return Step{Step::CloseParen, token, false};
+        }
+        case Token::Operator: {
+            const Operators::Info &incoming = token.info();
+            // A prefix operator has no left operand to complete
+            if (!incoming.unary) {
+                while (!stack.empty() && stack.back().kind == Token::Operator) {
+                    const int top = stack.back().info().precedence;
+                    if (top < incoming.precedence ||
+                        (top == incoming.precedence && incoming.associativity == Operators::Right)) {
+                        break;
+                    }
+                    emitOperator(stack.back());
+                    stack.pop_back();
+                }
+            }
+            stack.push_back(token);
+            return Step{Step::Operator, token, false};
+        }
+        case Token::Invalid:
+            break;
+    }
+    return Step{Step::Ignored, token, false};
+}
+
+bool ShuntingYard::isFinished() const
+{
+    return finished;
+}
+
+int ShuntingYard::position() const
+{
+    return index;
+}
+
+const std::string &ShuntingYard::input() const
+{
+    return infix;
+}
+
+const std::vector<Token> &ShuntingYard::tokens() const
+{
+    return tokenList;
+}
+
+const std::string &ShuntingYard::output() const
+{
+    return postfix;
+}
+
+const std::vector<Token> &ShuntingYard::operatorStack() const
+{
+    return stack;
+}
+
+std::string ShuntingYard::convert(const std::string &infix)
+{
+    // Streams the tokens instead of storing them like reset() does
+    ShuntingYard converter;
+    converter.infix = infix;
+    converter.source = converter.infix;
+    converter.postfix.reserve(infix.size() + infix.size() / 2);
+    Tokenizer tokenizer(converter.source);
+    Token token;
+    while (tokenizer.next(token)) {
+        converter.process(token);
+    }
+    converter.finish();
+    return converter.postfix;
+}
+
+std::string ShuntingYard::convertParallel(const std::string &infix, int threads)
+{
+    if (threads <= 0) {
+        threads = int(std::thread::hardware_concurrency());
+    }
+    threads = int(std::min(std::size_t(std::max(threads, 1)), infix.size() / PARALLEL_MIN_BYTES));
+    if (threads <= 1) {
+        return convert(infix);
+    }
+
+    // One block per thread, each starting where it can be tokenized alone
+    const std::string_view source = infix;
+    std::vector<BlockScan> blocks(threads);
+    for (int i = 1; i < threads; i++) {
+        std::size_t begin = std::max(blocks[i - 1].begin, infix.size() / threads * i);
+        while (begin < infix.size() && !Tokenizer::isResumePoint(source, begin)) begin++;
+        blocks[i].begin = begin;
+        blocks[i - 1].end = begin;
+    }
+    blocks.back().end = infix.size();
+    runParallel(threads, [&](int i) { scanBlock(source, blocks[i]); });
+
+    // The exclusive prefix sum of the depth changes is each block's starting
+    // depth. Where that plus its minDepth is 0, its outermost tokens are top-level
+    std::vector<char> topLevel(threads, 0);
+    int depth = 0;
+    int lowest = INT_MAX;
+    for (int i = 0; i < threads; i++) {
+        const int outer = depth + blocks[i].minDepth;
+        if (outer < 0) {
+            return convert(infix);
+        }
+        if (outer == 0) {
+            topLevel[i] = 1;
+            lowest = std::min(lowest, blocks[i].minPrecedence);
+        }
+        depth += blocks[i].depthChange;
+    }
+    if (depth != 0) {
+        return convert(infix);
+    }
+
+    // A left-associative binary operator of the lowest top-level precedence
+    // pops the whole stack, so the conversion restarts there with just that
+    // operator on it. Cut before the first one in each block.
+    std::vector<Token> cuts;
+    for (int i = 1; i < threads; i++) {
+        if (!topLevel[i]) continue;
+        Token cut{Token::Operator, 0, NO_SPLIT, 0};
+        for (int op = 0; op < Operators::COUNT; op++) {
+            const Operators::Info &info = Operators::TABLE[op];
+            if (info.precedence == lowest && info.associativity == Operators::Left &&
+                blocks[i].firstSplit[op] < cut.offset) {
+                cut = Token{Token::Operator, std::uint8_t(op), blocks[i].firstSplit[op],
+                            std::uint32_t(info.symbol.size())};
+            }
+        }
+        if (cut.offset != NO_SPLIT) {
+            cuts.push_back(cut);
+        }
+    }
+    if (cuts.empty()) {
+        return convert(infix);
+    }
+
+    std::vector<std::string> pieces(cuts.size() + 1);
+    runParallel(int(pieces.size()), [&](int i) {
+        ShuntingYard converter;
+        converter.source = source;
+        std::size_t begin = 0;
+        if (i > 0) {
+            converter.stack.push_back(cuts[i - 1]);
+            begin = cuts[i - 1].offset + cuts[i - 1].length;
+        }
+        const std::size_t end = std::size_t(i) < cuts.size() ? cuts[i].offset : infix.size();
+        converter.postfix.reserve(end - begin + (end - begin) / 2);
+        Tokenizer tokenizer(source, begin);
+        Token token;
+        while (tokenizer.next(token) && token.offset < end) {
+            converter.process(token);
+        }
+        converter.finish();
+        pieces[i] = std::move(converter.postfix);
+    });
+
+    std::size_t length = 0;
+    for (const std::string &piece : pieces) {
+        length += piece.size() + 1;
+    }
+    std::string postfix;
+    postfix.reserve(length);
+    for (const std::string &piece : pieces) {
+        if (piece.empty()) continue;
+        if (!postfix.empty()) {
+            postfix += ' ';
+        }
+        postfix += piece;
+    }
+    return postfix;
+}
+
+bool ShuntingYard::convertFile(const std::string &inputPath, const std::string &outputPath,
+                               FileStats *stats, std::string *error,
+                               const std::function<bool(std::uint64_t)> &progress)
+{
+    const auto started = std::chrono::steady_clock::now();
+    MappedFile mapping;
+    if (!mapping.open(inputPath, error)) {
+        return false;
+    }
+    // Token offsets are 32-bit
+    if (mapping.size() > std::numeric_limits<std::uint32_t>::max()) {
+        if (error) *error = inputPath + " is larger than 4 GiB";
+        return false;
+    }
+    std::FILE *file = std::fopen(outputPath.c_str(), "wb");
+    if (!file) {
+        if (error) *error = "Cannot create " + outputPath + ": " + std::strerror(errno);
+        return false;
+    }
+
+    ShuntingYard converter;
+    converter.source = std::string_view(mapping.data(), mapping.size());
+    converter.postfix.reserve(FLUSH_BYTES + 256);
+    FileStats totals;
+    totals.inputBytes = mapping.size();
+    bool written = true;
+    bool cancelled = false;
+    const auto flush = [&] {
+        written = written && std::fwrite(converter.postfix.data(), 1, converter.postfix.size(), file) ==
+                                 converter.postfix.size();
+        converter.flushed += converter.postfix.size();
+        converter.postfix.clear();
+    };
+
+    Tokenizer tokenizer(converter.source);
+    Token token;
+    std::uint64_t nextProgress = PROGRESS_BYTES;
+    while (written && tokenizer.next(token)) {
+        converter.process(token);
+        totals.tokens++;
+        totals.maxStackDepth = std::max(totals.maxStackDepth, converter.stack.size());
+        if (converter.postfix.size() >= FLUSH_BYTES) {
+            flush();
+        }
+        if (progress && token.offset >= nextProgress) {
+            nextProgress = token.offset + PROGRESS_BYTES;
+            if (!progress(token.offset)) {
+                cancelled = true;
+                break;
+            }
+        }
+    }
+    if (!cancelled) {
+        totals.unmatchedParen = converter.finish().unmatchedParen;
+        converter.postfix += '\n';
+    }
+    flush();
+    written = std::fclose(file) == 0 && written;
+    if (!written) {
+        if (error) *error = "Cannot write " + outputPath + ": " + std::strerror(errno);
+        return false;
+    }
+    if (cancelled) {
+        if (error) *error = "Conversion cancelled";
+        return false;
+    }
+
+    totals.outputBytes = converter.flushed;
+    totals.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+    if (stats) *stats = totals;
+    return true;
+}
+
+void ShuntingYard::emit(std::string_view text)
+{
+    if (!postfix.empty() || flushed > 0) {
+        postfix += ' ';
+    }
+    postfix.append(text.data(), text.size());
+}
+
+void ShuntingYard::emitOperator(const Token &token)
+{
+    emit(token.kind == Token::Operator ? token.info().postfix : token.text(source));
+}
@@ -0,0 +1,98 @@
+#ifndef SHUNTINGYARD_H
+#define SHUNTINGYARD_H
+
+#include "tokenizer.h"
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// Step-wise infix to postfix conversion, one token per step; has no GUI
+// dependencies. Postfix tokens are separated by single spaces, functions
+// are written after their arguments ("max(a, b)" gives "a b max") and the
+// unary minus as "neg".
+class ShuntingYard
+{
+public:
+    struct Step {
+        enum Action { Operand, OpenParen, CloseParen, UnmatchedClose, Operator, Function, Comma, Ignored, Finished } action;
+        // Token processed, or for Finished the last operator drained (length 0 if none)
+        Token token;
+        // Finished: an unmatched parenthesis was drained. Comma: there was
+        // no enclosing parenthesis
+        bool unmatchedParen;
+    };
+
+    // Totals of a convertFile() run
+    struct FileStats {
+        std::uint64_t inputBytes = 0;
+        std::uint64_t outputBytes = 0;
+        std::uint64_t tokens = 0;
+        std::size_t maxStackDepth = 0;
+        double seconds = 0.0;
+        bool unmatchedParen = false;
+
+        double megabytesPerSecond() const;
+    };
+
+    ShuntingYard();
+
+    // The input is referenced, not copied, by convertFile()
+    ShuntingYard(const ShuntingYard &) = delete;
+    ShuntingYard &operator=(const ShuntingYard &) = delete;
+
+    void reset(const std::string &infix);
+    Step step();
+    bool isFinished() const;
+
+    // Index of the token processed next
+    int position() const;
+    const std::string &input() const;
+    const std::vector<Token> &tokens() const;
+    const std::string &output() const;
+    const std::vector<Token> &operatorStack() const;
+
+    // Converts a whole expression at full speed
+    static std::string convert(const std::string &infix);
+    // Converts the expression in one file into another in a single pass. The
+    // input is memory mapped and the output written in FLUSH_BYTES blocks, so
+    // memory use is bounded by the nesting depth, not the file size.
+    // The output is convert() followed by a newline. progress(bytesRead) is
+    // called every PROGRESS_BYTES and may return false to cancel, which
+    // leaves a partial output file.
+    static bool convertFile(const std::string &inputPath, const std::string &outputPath,
+                            FileStats *stats = nullptr, std::string *error = nullptr,
+                            const std::function<bool(std::uint64_t)> &progress = {});
+
+    // Same output as convert(), split across threads (0: one per core). The
+    // expression is cut before top-level operators of its lowest precedence,
+    // where the sequential algorithm empties its stack, and the pieces are
+    // converted independently. Unbalanced parentheses, or no such operator
+    // to cut at, fall back to convert().
+    static std::string convertParallel(const std::string &infix, int threads = 0);
+
+    static const std::size_t FLUSH_BYTES = 1 << 16;
+    // Smallest share of the input worth a thread of its own
+    static const std::size_t PARALLEL_MIN_BYTES = 1 << 16;
+    static const std::uint64_t PROGRESS_BYTES = 1 << 20;
+
+private:
+    std::string infix;
+    // Text the tokens refer to: infix, or a mapped file in convertFile()
+    std::string_view source;
+    std::vector<Token> tokenList;
+    std::string postfix;
+    // Output already written out by convertFile()
+    std::uint64_t flushed;
+    std::vector<Token> stack;
+    int index;
+    bool finished;
+
+    Step process(const Token &token);
+    Step finish();
+    void emit(std::string_view text);
+    void emitOperator(const Token &token);
+};
+
+#endif // SHUNTINGYARD_H
@@ -0,0 +1,94 @@
+#include "spscpipeline.h"
+
+namespace {
+// Stall counters are published in batches to keep the shared lines quiet
+const std::uint64_t PUBLISH_INTERVAL = 1024;
+}
+
+SpscPipeline::SpscPipeline()
+    : running(false)
+    , producerStalls(0)
+    , consumerStalls(0)
+    , orderErrors(0)
+{
+}
+
+SpscPipeline::~SpscPipeline()
+{
+    stop();
+}
+
+void SpscPipeline::start(std::size_t capacity)
+{
+    stop();
+
+    ring.reset(new SpscRing<std::uint64_t>(capacity));
+    producerStalls.store(0, std::memory_order_relaxed);
+    consumerStalls.store(0, std::memory_order_relaxed);
+    orderErrors.store(0, std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+    producer = std::thread(&SpscPipeline::produce, this);
+    consumer = std::thread(&SpscPipeline::consume, this);
+}
+
+void SpscPipeline::stop()
+{
+    running.store(false, std::memory_order_release);
+    if (producer.joinable()) producer.join();
+    if (consumer.joinable()) consumer.join();
+}
+
+bool SpscPipeline::isRunning() const
+{
+    return running.load(std::memory_order_acquire);
+}
+
+SpscPipeline::Snapshot SpscPipeline::snapshot() const
+{
+    Snapshot snap{};
+    if (!ring) return snap;
+
+    snap.head = ring->head();
+    snap.tail = ring->tail();
+    snap.capacity = ring->capacity();
+    snap.producerStalls = producerStalls.load(std::memory_order_relaxed);
+    snap.consumerStalls = consumerStalls.load(std::memory_order_relaxed);
+    snap.orderErrors = orderErrors.load(std::memory_order_relaxed);
+    return snap;
+}
+
+void SpscPipeline::produce()
+{
+    std::uint64_t next = 0;
+    std::uint64_t stalls = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        if (ring->tryPush(next)) {
+            next++;
+        } else if (++stalls % PUBLISH_INTERVAL == 0) {
+            producerStalls.fetch_add(PUBLISH_INTERVAL, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    }
+    producerStalls.fetch_add(stalls % PUBLISH_INTERVAL, std::memory_order_relaxed);
+}
+
+void SpscPipeline::consume()
+{
+    std::uint64_t expected = 0;
+    std::uint64_t stalls = 0;
+    std::uint64_t errors = 0;
+    std::uint64_t value = 0;
+    while (running.load(std::memory_order_relaxed)) {
+        if (ring->tryPop(value)) {
+            if (value != expected) {
+                errors++;
+                orderErrors.store(errors, std::memory_order_relaxed);
+            }
+            expected = value + 1;
+        } else if (++stalls % PUBLISH_INTERVAL == 0) {
+            consumerStalls.fetch_add(PUBLISH_INTERVAL, std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    }
+    consumerStalls.fetch_add(stalls % PUBLISH_INTERVAL, std::memory_order_relaxed);
+}
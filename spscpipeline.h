@@ -0,0 +1,51 @@
+#ifndef SPSCPIPELINE_H
+#define SPSCPIPELINE_H
+
+#include "spscring.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+// A producer thread streams sequence numbers through an SpscRing to a
+// consumer thread. Observers only read atomics through snapshot(), so
+// watching the pipeline never blocks either thread.
+class SpscPipeline
+{
+public:
+    struct Snapshot {
+        std::uint64_t head;
+        std::uint64_t tail;
+        std::size_t capacity;
+        // Times the producer found the ring full or the consumer found it empty
+        std::uint64_t producerStalls;
+        std::uint64_t consumerStalls;
+        // Values that did not arrive in the order they were sent
+        std::uint64_t orderErrors;
+    };
+
+    SpscPipeline();
+    ~SpscPipeline();
+
+    SpscPipeline(const SpscPipeline &) = delete;
+    SpscPipeline &operator=(const SpscPipeline &) = delete;
+
+    void start(std::size_t capacity);
+    void stop();
+    bool isRunning() const;
+    Snapshot snapshot() const;
+
+private:
+    std::unique_ptr<SpscRing<std::uint64_t>> ring;
+    std::thread producer;
+    std::thread consumer;
+    std::atomic<bool> running;
+    std::atomic<std::uint64_t> producerStalls;
+    std::atomic<std::uint64_t> consumerStalls;
+    std::atomic<std::uint64_t> orderErrors;
+
+    void produce();
+    void consume();
+};
+
+#endif // SPSCPIPELINE_H
@@ -0,0 +1,100 @@
+#ifndef SPSCRING_H
+#define SPSCRING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+// Lock-free ring buffer for exactly one producer thread and one consumer
+// thread. head and tail are free-running counters; a slot index is the
+// counter masked by the power-of-two capacity. Each side keeps its counter
+// and a cached copy of the other side's counter on its own cache line, so
+// the two threads only share a line when the cached copy runs out.
+template <typename T>
+class SpscRing
+{
+public:
+    static constexpr std::size_t CACHE_LINE = 64;
+
+    // capacity is rounded up to a power of two
+    explicit SpscRing(std::size_t capacity)
+        : mask(roundUp(capacity) - 1)
+        , slots(new T[mask + 1])
+    {
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    // Producer thread only
+    bool tryPush(const T &value)
+    {
+        const std::uint64_t t = producer.tail.load(std::memory_order_relaxed);
+        if (t - producer.cachedHead > mask) {
+            producer.cachedHead = consumer.head.load(std::memory_order_acquire);
+            if (t - producer.cachedHead > mask) {
+                return false;
+            }
+        }
+        slots[t & mask] = value;
+        producer.tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer thread only
+    bool tryPop(T &value)
+    {
+        const std::uint64_t h = consumer.head.load(std::memory_order_relaxed);
+        if (h == consumer.cachedTail) {
+            consumer.cachedTail = producer.tail.load(std::memory_order_acquire);
+            if (h == consumer.cachedTail) {
+                return false;
+            }
+        }
+        value = slots[h & mask];
+        consumer.head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+
+    std::size_t capacity() const
+    {
+        return mask + 1;
+    }
+
+    // Any thread; a snapshot may be stale by the time it is used, and
+    // tail >= head only holds when head is read first
+    std::uint64_t head() const
+    {
+        return consumer.head.load(std::memory_order_acquire);
+    }
+
+    std::uint64_t tail() const
+    {
+        return producer.tail.load(std::memory_order_acquire);
+    }
+
+private:
+    struct alignas(CACHE_LINE) ProducerSide {
+        std::atomic<std::uint64_t> tail{0};
+        std::uint64_t cachedHead = 0;
+    };
+    struct alignas(CACHE_LINE) ConsumerSide {
+        std::atomic<std::uint64_t> head{0};
+        std::uint64_t cachedTail = 0;
+    };
+
+    ProducerSide producer;
+    ConsumerSide consumer;
+    alignas(CACHE_LINE) const std::size_t mask;
+    const std::unique_ptr<T[]> slots;
+
+    static std::size_t roundUp(std::size_t capacity)
+    {
+        std::size_t size = 1;
+        while (size < capacity) size <<= 1;
+        return size;
+    }
+};
+
+#endif // SPSCRING_H
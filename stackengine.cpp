@@ -0,0 +1,244 @@
+#include "stackengine.h"
+#include "traceevents.h"
+#include <cstdlib>
+
+StackEngine::StackEngine(int capacity)
+    : maxSize(capacity)
+    , historyEnabled(true)
+    , observer(nullptr)
+{
+}
+
+bool StackEngine::push(int value)
+{
+    DSV_TRACE_SCOPE("StackEngine::push");
+    if (isFull()) {
+        notify(EngineEvent::Overflow, Operation{Operation::Insert, value});
+        return false;
+    }
+
+    storage.push(value);
+    if (historyEnabled) {
+        DSV_TRACE_SCOPE("addToHistory");
+        ops.record(Operation{Operation::Insert, value});
+        recorded();
+    }
+    notify(EngineEvent::Inserted, Operation{Operation::Insert, value});
+    return true;
+}
+
+int StackEngine::pop()
+{
+    DSV_TRACE_SCOPE("StackEngine::pop");
+    if (isEmpty()) {
+        notify(EngineEvent::Underflow, Operation{Operation::Remove, -1});
+        return -1;
+    }
+
+    int value = storage.pop();
+    if (historyEnabled) {
+        DSV_TRACE_SCOPE("addToHistory");
+        ops.record(Operation{Operation::Remove, value});
+        recorded();
+    }
+    notify(EngineEvent::Removed, Operation{Operation::Remove, value});
+    return value;
+}
+
+int StackEngine::peek() const
+{
+    if (isEmpty()) {
+        return -1;
+    }
+    return storage.top();
+}
+
+bool StackEngine::isEmpty() const
+{
+    return storage.isEmpty();
+}
+
+bool StackEngine::isFull() const
+{
+    return storage.size() >= maxSize;
+}
+
+void StackEngine::clear()
+{
+    DSV_TRACE_SCOPE("StackEngine::clear");
+    if (isEmpty()) return;
+
+    if (historyEnabled) {
+        DSV_TRACE_SCOPE("addToHistory");
+        ops.recordClear(getCurrentState());
+    }
+    storage.clear();
+    notify(EngineEvent::Cleared, Operation{Operation::Clear, 0});
+}
+
+bool StackEngine::undo()
+{
+    DSV_TRACE_SCOPE("StackEngine::undo");
+    if (!ops.canUndo()) return false;
+
+    const int index = ops.currentIndex();
+    const Operation &op = ops.undo();
+    revert(op, index);
+    notify(EngineEvent::Undone, op);
+    return true;
+}
+
+bool StackEngine::redo()
+{
+    DSV_TRACE_SCOPE("StackEngine::redo");
+    if (!ops.canRedo()) return false;
+
+    const Operation &op = ops.redo();
+    apply(op);
+    notify(EngineEvent::Redone, op);
+    return true;
+}
+
+bool StackEngine::seek(int index)
+{
+    DSV_TRACE_SCOPE("StackEngine::seek");
+    if (index < ops.beginIndex() - 1 || index >= ops.endIndex()) return false;
+
+    // Restore the nearest checkpoint when that beats stepping one by one
+    const OperationHistory::Checkpoint *checkpoint = ops.checkpointAtOrBefore(index);
+    const long long stepCost = std::abs(index - ops.currentIndex());
+    if (checkpoint && (index - checkpoint->index) + static_cast<long long>(checkpoint->state.size()) < stepCost) {
+        restore(checkpoint->state);
+        ops.setCurrentIndex(checkpoint->index);
+    }
+    while (ops.currentIndex() < index) {
+        apply(ops.redo());
+    }
+    while (ops.currentIndex() > index) {
+        const int current = ops.currentIndex();
+        revert(ops.undo(), current);
+    }
+
+    notify(EngineEvent::Jumped, Operation{Operation::Clear, 0});
+    return true;
+}
+
+int StackEngine::size() const
+{
+    return storage.size();
+}
+
+int StackEngine::capacity() const
+{
+    return maxSize;
+}
+
+bool StackEngine::setCapacity(int capacity)
+{
+    if (capacity < storage.size() || capacity < 1 || capacity > MAX_CAPACITY) {
+        return false;
+    }
+    maxSize = capacity;
+    return true;
+}
+
+int StackEngine::at(int index) const
+{
+    return storage.at(index);
+}
+
+std::size_t StackEngine::allocatedBytes() const
+{
+    return storage.allocatedBytes();
+}
+
+std::size_t StackEngine::usedBytes() const
+{
+    return storage.usedBytes();
+}
+
+std::vector<int> StackEngine::getCurrentState() const
+{
+    std::vector<int> state;
+    storage.copyTo(state);
+    return state;
+}
+
+const OperationHistory &StackEngine::history() const
+{
+    return ops;
+}
+
+void StackEngine::setHistoryEnabled(bool enabled)
+{
+    historyEnabled = enabled;
+}
+
+bool StackEngine::isHistoryEnabled() const
+{
+    return historyEnabled;
+}
+
+void StackEngine::setHistoryBudget(std::size_t bytes)
+{
+    ops.setMemoryBudget(bytes);
+}
+
+void StackEngine::clearHistory()
+{
+    ops.clear();
+}
+
+void StackEngine::setObserver(EngineObserver *observer)
+{
+    this->observer = observer;
+}
+
+void StackEngine::recorded()
+{
+    if (ops.wantsCheckpoint(storage.size())) {
+        ops.addCheckpoint(getCurrentState());
+    }
+}
+
+void StackEngine::apply(const Operation &op)
+{
+    switch (op.type) {
+        case Operation::Insert:
+            storage.push(op.value);
+            break;
+        case Operation::Remove:
+            storage.pop();
+            break;
+        case Operation::Clear:
+            storage.clear();
+            break;
+    }
+}
+
+void StackEngine::revert(const Operation &op, int index)
+{
+    switch (op.type) {
+        case Operation::Insert:
+            storage.pop();
+            break;
+        case Operation::Remove:
+            storage.push(op.value);
+            break;
+        case Operation::Clear:
+            storage.assign(ops.clearedState(index));
+            break;
+    }
+}
+
+void StackEngine::restore(const std::vector<int> &state)
+{
+    storage.assign(state);
+}
+
+void StackEngine::notify(EngineEvent::Type type, Operation op)
+{
+    if (observer) {
+        observer->engineChanged(EngineEvent{type, op});
+    }
+}
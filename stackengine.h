@@ -0,0 +1,62 @@
+#ifndef STACKENGINE_H
+#define STACKENGINE_H
+
+#include "engineobserver.h"
+#include "operationhistory.h"
+#include "segmentedstack.h"
+#include <vector>
+
+// Stack with undo/redo over chunked storage; has no GUI dependencies
+class StackEngine
+{
+public:
+    static const int DEFAULT_CAPACITY = 5;
+    static const int MAX_CAPACITY = 1 << 30;
+
+    explicit StackEngine(int capacity = DEFAULT_CAPACITY);
+
+    bool push(int value);
+    int pop();
+    int peek() const;
+    bool isEmpty() const;
+    bool isFull() const;
+    void clear();
+    bool undo();
+    bool redo();
+    // Moves to the state right after history entry index (beginIndex() - 1
+    // for the oldest reachable state), via the nearest checkpoint if cheaper
+    bool seek(int index);
+
+    int size() const;
+    int capacity() const;
+    // Fails if the new limit is below the current size
+    bool setCapacity(int capacity);
+    int at(int index) const;
+    std::size_t allocatedBytes() const;
+    std::size_t usedBytes() const;
+    std::vector<int> getCurrentState() const;
+
+    const OperationHistory &history() const;
+    // Bulk loads and benchmarks can bypass the undo history entirely
+    void setHistoryEnabled(bool enabled);
+    bool isHistoryEnabled() const;
+    void setHistoryBudget(std::size_t bytes);
+    // Forgets every recorded operation; the current state becomes the oldest
+    void clearHistory();
+    void setObserver(EngineObserver *observer);
+
+private:
+    SegmentedStack storage;
+    int maxSize;
+    OperationHistory ops;
+    bool historyEnabled;
+    EngineObserver *observer;
+
+    void recorded();
+    void apply(const Operation &op);
+    void revert(const Operation &op, int index);
+    void restore(const std::vector<int> &state);
+    void notify(EngineEvent::Type type, Operation op);
+};
+
+#endif // STACKENGINE_H
@@ -1,4 +1,5 @@
 #include "stackvisualizer.h"
+#include "traceevents.h"
 #include <QVBoxLayout>
 #include <QHBoxLayout>
 #include <QGraphicsRectItem>
@@ -9,19 +10,35 @@
 #include <QLineEdit>
 #include <QLabel>
 #include <QGroupBox>
+#include <QSpinBox>
+#include <QLocale>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QGraphicsSimpleTextItem>
+#include <QGraphicsLineItem>
+
+namespace {
+// Stack cell layout; slot 0 sits on the base line and slots grow upwards
+const int CELL_WIDTH = 60;
+const int CELL_HEIGHT = 30;
+const int CELL_SPACING = 5;
+const int START_X = 10;
+// Slots below the top this many are summarized instead of drawn
+const int MAX_SHOWN_CELLS = 2048;
+}
 
 StackVisualizer::StackVisualizer(QWidget *parent)
     : QWidget(parent)
-    , top(-1)
-    , isAnimating(false)
-    , animationStep(0)
-    , currentHistoryIndex(-1)
+    , baseLine(nullptr)
+    , hiddenLabel(nullptr)
+    , shownBase(0)
+    , shownCount(0)
+    , syncedFrom(0)
+    , historyBeforeReplay(true)
 {
     setupUI();
 
-    // Setup animation timer
-    animationTimer = new QTimer(this);
-    connect(animationTimer, &QTimer::timeout, this, &StackVisualizer::animateOperation);
+    animator = new SceneAnimator(this);
 
     // Connect signals
     connect(pushButton, &QPushButton::clicked, this, [this]() {
@@ -50,6 +67,37 @@ StackVisualizer::StackVisualizer(QWidget *parent)
     connect(clearButton, &QPushButton::clicked, this, &StackVisualizer::clear);
     connect(undoButton, &QPushButton::clicked, this, &StackVisualizer::undoOperation);
     connect(redoButton, &QPushButton::clicked, this, &StackVisualizer::redoOperation);
+    connect(recordButton, &QPushButton::clicked, this, &StackVisualizer::toggleRecording);
+    connect(historyView, &QListView::clicked, this, [this](const QModelIndex &index) {
+        engine.seek(historyModel->absoluteIndex(index.row()));
+    });
+    connect(historyModel, &HistoryModel::synchronized, this, &StackVisualizer::selectHistoryRow);
+    connect(historyBudgetSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int megabytes) {
+        engine.setHistoryBudget(std::size_t(megabytes) * 1024 * 1024);
+        historyModel->scheduleSync(engine.history().endIndex());
+        updateCapacityIndicator();
+    });
+
+    connect(capacitySpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int value) {
+        if (!engine.setCapacity(value)) {
+            setStatusMessage("Capacity cannot be below the current size");
+            capacitySpinBox->setValue(engine.capacity());
+            return;
+        }
+        updateButtons();
+        updateCapacityIndicator();
+    });
+
+    traceReplayPanel->setHandlers(
+        [this](const OperationTrace &trace) { beginReplay(trace); },
+        [this](OperationTrace &trace, const QElapsedTimer &clock, qint64 deadlineNs) {
+            return replayFrame(trace, clock, deadlineNs);
+        },
+        [this]() { syncAfterReplay(); },
+        [this]() { endReplay(); });
+
+    // The engine drives every view update from here on
+    engine.setObserver(this);
 
     // Initialize
     updateVisualization();
@@ -58,161 +106,238 @@ StackVisualizer::StackVisualizer(QWidget *parent)
 
 StackVisualizer::~StackVisualizer()
 {
+    engine.setObserver(nullptr);
     delete scene;
 }
 
 bool StackVisualizer::push(int value)
 {
-    if (isFull()) {
-        setStatusMessage("Stack Overflow!");
-        return false;
-    }
-
-    addToHistory(Operation::PUSH, value);
-    arr[++top] = value;
-    updateVisualization();
-    setStatusMessage(QString("Pushed value: %1").arg(value));
-    
-    // Start animation after updating
-    if (!isAnimating) {
-        animationStep = 0;
-        isAnimating = true;
-        animationTimer->start(100);
-    }
-    
-    emit stateChanged();
-    return true;
+    return engine.push(value);
 }
 
 int StackVisualizer::pop()
 {
-    if (isEmpty()) {
-        setStatusMessage("Stack Underflow!");
-        return -1;
-    }
-
-    int value = arr[top];
-    addToHistory(Operation::POP, value);
-    top--;
-    updateVisualization();
-    setStatusMessage(QString("Popped value: %1").arg(value));
-    
-    // Start animation after updating
-    if (!isAnimating) {
-        animationStep = 0;
-        isAnimating = true;
-        animationTimer->start(100);
-    }
-    
-    emit stateChanged();
-    return value;
+    return engine.pop();
 }
 
 int StackVisualizer::peek() const
 {
-    if (isEmpty()) {
-        return -1;
-    }
-    return arr[top];
+    return engine.peek();
 }
 
-void StackVisualizer::addToHistory(Operation::Type type, int value)
+void StackVisualizer::engineChanged(const EngineEvent &event)
 {
-    // Remove any operations after current index if we're in the middle of history
-    while (history.size() > currentHistoryIndex + 1) {
-        history.removeLast();
+    if (recorder.isOpen()) {
+        recorder.record(event.type, event.op.type,
+                        event.type == EngineEvent::Jumped ? engine.history().currentIndex() : event.op.value);
     }
 
-    Operation op;
-    op.type = type;
-    op.value = value;
-    op.prevState = getCurrentState();
-    history.append(op);
-    currentHistoryIndex++;
-
-    // Update history list widget
-    QString operationText;
-    switch (type) {
-        case Operation::PUSH:
-            operationText = QString("Push %1").arg(value);
+    switch (event.type) {
+        case EngineEvent::Overflow:
+            setStatusMessage("Stack Overflow!");
+            return;
+        case EngineEvent::Underflow:
+            setStatusMessage("Stack Underflow!");
+            return;
+        case EngineEvent::Inserted:
+            syncHistoryList();
+            setStatusMessage(QString("Pushed value: %1").arg(event.op.value));
+            break;
+        case EngineEvent::Removed:
+            syncHistoryList();
+            setStatusMessage(QString("Popped value: %1").arg(event.op.value));
+            break;
+        case EngineEvent::Cleared:
+            syncHistoryList();
+            setStatusMessage("Stack cleared");
+            break;
+        case EngineEvent::Undone:
+            selectHistoryRow();
+            setStatusMessage("Undo: " + historyModel->label(event.op));
             break;
-        case Operation::POP:
-            operationText = QString("Pop %1").arg(value);
+        case EngineEvent::Redone:
+            selectHistoryRow();
+            setStatusMessage("Redo: " + historyModel->label(event.op));
             break;
-        case Operation::CLEAR:
-            operationText = "Clear";
+        case EngineEvent::Jumped:
+            selectHistoryRow();
+            setStatusMessage(QString("Jumped to history step %1").arg(engine.history().currentIndex() + 1));
             break;
     }
-    historyList->addItem(operationText);
-    historyList->setCurrentRow(currentHistoryIndex);
+
+    perfHud->addOperations(1);
     updateButtons();
+    updateCapacityIndicator();
+    // Every write to the stack lands at or above the smallest size seen,
+    // except a seek, which may restore a checkpoint wholesale
+    syncedFrom = event.type == EngineEvent::Jumped ? 0 : qMin(syncedFrom, engine.size());
+    updateVisualization();
+    animateOperation(event);
+
+    emit stateChanged();
 }
 
-void StackVisualizer::undoOperation()
+void StackVisualizer::syncHistoryList()
 {
-    if (currentHistoryIndex < 0 || isAnimating) return;
+    if (!engine.isHistoryEnabled()) return;
 
-    Operation &op = history[currentHistoryIndex];
-    switch (op.type) {
-        case Operation::PUSH:
-            top--;
-            break;
-        case Operation::POP:
-            top++;
-            arr[top] = op.value;
-            break;
-        case Operation::CLEAR:
-            for (int i = 0; i < op.prevState.size(); i++) {
-                arr[i] = op.prevState[i];
-            }
-            top = op.prevState.size() - 1;
-            break;
+    // The new entry replaces any redo tail; rows are inserted once per frame
+    historyModel->scheduleSync(engine.history().currentIndex());
+}
+
+void StackVisualizer::selectHistoryRow()
+{
+    const int row = historyModel->rowOf(engine.history().currentIndex());
+    const QModelIndex index = historyModel->index(row, 0);
+    historyView->setCurrentIndex(index);
+    if (index.isValid()) {
+        historyView->scrollTo(index);
     }
+}
 
-    currentHistoryIndex--;
-    historyList->setCurrentRow(currentHistoryIndex);
-    updateButtons();
-    updateVisualization();
-    setStatusMessage("Undo: " + historyList->item(currentHistoryIndex + 1)->text());
+bool StackVisualizer::setCapacity(int capacity)
+{
+    capacitySpinBox->setValue(capacity);
+    return engine.capacity() == capacity;
+}
+
+void StackVisualizer::setHistoryEnabled(bool enabled)
+{
+    engine.setHistoryEnabled(enabled);
+}
+
+void StackVisualizer::toggleRecording()
+{
+    std::string error;
+    if (recorder.isOpen()) {
+        const qint64 records = qint64(recorder.recordCount());
+        const qint64 bytes = qint64(recorder.bytesWritten());
+        recordButton->setText("Record Session...");
+        traceReplayPanel->setEnabled(true);
+        if (!recorder.close(&error)) {
+            setStatusMessage("Recording failed: " + QString::fromStdString(error));
+            return;
+        }
+        setStatusMessage(QString("Recorded %1 operations (%2)")
+                             .arg(QLocale().toString(records))
+                             .arg(QLocale().formattedDataSize(bytes)));
+        return;
+    }
+
+    const QString path = QFileDialog::getSaveFileName(this, "Record Session", "stack-session.dsvlog",
+                                                      "Session logs (*.dsvlog)");
+    if (path.isEmpty()) return;
+    if (!recorder.open(path.toStdString(), SessionLog::Stack, &error)) {
+        setStatusMessage(QString::fromStdString(error));
+        return;
+    }
+    recordButton->setText("Stop Recording");
+    // Replays bypass the observer and the history, so they would be missing
+    // from the log
+    traceReplayPanel->setEnabled(false);
+    setStatusMessage("Recording to " + QFileInfo(path).fileName());
+}
+
+void StackVisualizer::undoOperation()
+{
+    DSV_TRACE_SCOPE("StackVisualizer::undoOperation");
+    engine.undo();
 }
 
 void StackVisualizer::redoOperation()
 {
-    if (currentHistoryIndex >= history.size() - 1 || isAnimating) return;
+    DSV_TRACE_SCOPE("StackVisualizer::redoOperation");
+    engine.redo();
+}
 
-    currentHistoryIndex++;
-    Operation &op = history[currentHistoryIndex];
-    switch (op.type) {
-        case Operation::PUSH:
-            top++;
-            arr[top] = op.value;
-            break;
-        case Operation::POP:
-            top--;
-            break;
-        case Operation::CLEAR:
-            top = -1;
-            break;
+void StackVisualizer::beginReplay(const OperationTrace &trace)
+{
+    engine.clear();
+    engine.clearHistory();
+    if (engine.capacity() < trace.peakSize()) {
+        capacitySpinBox->setValue(qMin(trace.peakSize(), capacitySpinBox->maximum()));
     }
+    // Recording millions of replayed operations would only evict the budget
+    historyBeforeReplay = engine.isHistoryEnabled();
+    recordButton->setEnabled(false);
+    engine.setHistoryEnabled(false);
+    historyModel->reset();
+}
 
-    historyList->setCurrentRow(currentHistoryIndex);
-    updateButtons();
+long long StackVisualizer::replayFrame(OperationTrace &trace, const QElapsedTimer &clock, qint64 deadlineNs)
+{
+    // Replay with the observer detached so no per-operation view work runs;
+    // syncAfterReplay() brings the view up to date once for the whole frame
+    const int CHUNK = 4096;
+    engine.setObserver(nullptr);
+    long long applied = 0;
+    int lowest = engine.size();
+    Operation op;
+    bool more = true;
+    while (more && clock.nsecsElapsed() < deadlineNs) {
+        for (int n = 0; n < CHUNK && (more = trace.next(op)); n++) {
+            switch (op.type) {
+                case Operation::Insert:
+                    engine.push(op.value);
+                    break;
+                case Operation::Remove:
+                    engine.pop();
+                    lowest = qMin(lowest, engine.size());
+                    break;
+                case Operation::Clear:
+                    engine.clear();
+                    lowest = 0;
+                    break;
+            }
+            applied++;
+        }
+    }
+    engine.setObserver(this);
+    perfHud->addOperations(applied);
+    syncedFrom = qMin(syncedFrom, lowest);
+    return applied;
+}
+
+void StackVisualizer::syncAfterReplay()
+{
     updateVisualization();
-    setStatusMessage("Redo: " + historyList->item(currentHistoryIndex)->text());
+    updateButtons();
+    updateCapacityIndicator();
 }
 
-void StackVisualizer::animateOperation()
+void StackVisualizer::endReplay()
 {
-    if (!isAnimating) return;
+    engine.setHistoryEnabled(historyBeforeReplay);
+    recordButton->setEnabled(true);
+    historyModel->reset();
+    setStatusMessage(QString("Trace replay finished with %1 elements on the stack").arg(engine.size()));
+    emit stateChanged();
+}
 
-    // Animation logic here
-    animationStep++;
-    if (animationStep >= 5) { // Reduced from 10 to 5 for faster animation
-        isAnimating = false;
-        animationTimer->stop();
-        animationStep = 0;
+void StackVisualizer::animateOperation(const EngineEvent &event)
+{
+    DSV_TRACE_SCOPE("StackVisualizer::animateOperation");
+    // Only the pushed or popped cell moves; the rest of the scene is static
+    const int ANIMATION_MS = 250;
+    if (event.type == EngineEvent::Inserted) {
+        Cell &cell = cells[(engine.size() - 1) % MAX_SHOWN_CELLS];
+        const QPointF above(0, -(CELL_HEIGHT + CELL_SPACING));
+        QGraphicsItem *const items[] = {cell.box, cell.valueText};
+        for (QGraphicsItem *item : items) {
+            animator->animatePos(item, item->pos() + above, item->pos(), ANIMATION_MS);
+            animator->animateOpacity(item, 0.0, 1.0, ANIMATION_MS);
+        }
+    } else if (event.type == EngineEvent::Removed) {
+        // The popped cell was just hidden; fade it out instead, unless the
+        // window slid down and reused it for the slot below
+        Cell &cell = cells[engine.size() % MAX_SHOWN_CELLS];
+        if (cell.slot != engine.size()) return;
+        QGraphicsItem *const items[] = {cell.box, cell.valueText};
+        for (QGraphicsItem *item : items) {
+            item->setVisible(true);
+            animator->animateOpacity(item, 1.0, 0.0, ANIMATION_MS, true);
+        }
     }
-    updateVisualization();
 }
 
 void StackVisualizer::drawBox(int index, int value, const QString &color)
@@ -237,8 +362,14 @@ void StackVisualizer::drawBox(int index, int value, const QString &color)
 void StackVisualizer::updateCapacityIndicator()
 {
     QString style = isEmpty() ? "color: red;" : (isFull() ? "color: orange;" : "color: green;");
-    statusLabel->setStyleSheet(style);
-    statusLabel->setText(QString("Capacity: %1/%2").arg(top + 1).arg(MAX_SIZE));
+    capacityLabel->setStyleSheet(style);
+    QLocale locale;
+    capacityLabel->setText(QString("Capacity: %1/%2 - Memory: %3 used / %4 allocated - History: %5")
+                               .arg(engine.size())
+                               .arg(engine.capacity())
+                               .arg(locale.formattedDataSize(qint64(engine.usedBytes())))
+                               .arg(locale.formattedDataSize(qint64(engine.allocatedBytes())))
+                               .arg(locale.formattedDataSize(qint64(engine.history().memoryUsage()))));
 }
 
 void StackVisualizer::setupUI()
@@ -249,9 +380,11 @@ void StackVisualizer::setupUI()
     QGroupBox *visualizationGroup = new QGroupBox("Stack Visualization");
     QVBoxLayout *visualizationLayout = new QVBoxLayout;
     scene = new QGraphicsScene(this);
-    view = new QGraphicsView(scene);
+    view = new TimedGraphicsView(scene);
     view->setMinimumHeight(200);
     view->setRenderHint(QPainter::Antialiasing);
+    perfHud = new PerfHud("Stack", view);
+    perfHud->setHistoryBytesSource([this]() { return qint64(engine.history().memoryUsage()); });
     visualizationLayout->addWidget(view);
     visualizationGroup->setLayout(visualizationLayout);
     mainLayout->addWidget(visualizationGroup);
@@ -274,20 +407,49 @@ void StackVisualizer::setupUI()
     controlsLayout->addWidget(peekButton);
     controlsLayout->addWidget(clearButton);
 
+    capacitySpinBox = new QSpinBox;
+    capacitySpinBox->setPrefix("Capacity: ");
+    capacitySpinBox->setRange(1, 100000000);
+    capacitySpinBox->setValue(engine.capacity());
+    capacitySpinBox->setToolTip("Maximum number of elements before Stack Overflow");
+    controlsLayout->addWidget(capacitySpinBox);
+
     controlsGroup->setLayout(controlsLayout);
     mainLayout->addWidget(controlsGroup);
 
+    // Create work-stealing group
+    workStealingPanel = new WorkStealingPanel;
+    mainLayout->addWidget(workStealingPanel);
+
+    // Create trace replay group
+    traceReplayPanel = new TraceReplayPanel;
+    mainLayout->addWidget(traceReplayPanel);
+
     // Create history group
     QGroupBox *historyGroup = new QGroupBox("Operation History");
     QVBoxLayout *historyLayout = new QVBoxLayout;
-    historyList = new QListWidget;
-    historyLayout->addWidget(historyList);
+    historyModel = new HistoryModel(&engine.history(), "Push", "Pop", this);
+    historyView = new QListView;
+    historyView->setModel(historyModel);
+    historyView->setUniformItemSizes(true);
+    historyView->setEditTriggers(QAbstractItemView::NoEditTriggers);
+    historyLayout->addWidget(historyView);
 
     QHBoxLayout *historyButtonLayout = new QHBoxLayout;
     undoButton = new QPushButton("Undo");
     redoButton = new QPushButton("Redo");
+    recordButton = new QPushButton("Record Session...");
+    recordButton->setToolTip("Log every operation to a binary session file for later replay");
+    historyBudgetSpinBox = new QSpinBox;
+    historyBudgetSpinBox->setPrefix("Budget: ");
+    historyBudgetSpinBox->setSuffix(" MB");
+    historyBudgetSpinBox->setRange(1, 4096);
+    historyBudgetSpinBox->setValue(int(engine.history().memoryBudget() / (1024 * 1024)));
+    historyBudgetSpinBox->setToolTip("Oldest operations are forgotten once the history exceeds this size");
     historyButtonLayout->addWidget(undoButton);
     historyButtonLayout->addWidget(redoButton);
+    historyButtonLayout->addWidget(recordButton);
+    historyButtonLayout->addWidget(historyBudgetSpinBox);
     historyLayout->addLayout(historyButtonLayout);
 
     historyGroup->setLayout(historyLayout);
@@ -297,7 +459,9 @@ void StackVisualizer::setupUI()
     QGroupBox *statusGroup = new QGroupBox("Status");
     QVBoxLayout *statusLayout = new QVBoxLayout;
     statusLabel = new QLabel;
+    capacityLabel = new QLabel;
     statusLayout->addWidget(statusLabel);
+    statusLayout->addWidget(capacityLabel);
     statusGroup->setLayout(statusLayout);
     mainLayout->addWidget(statusGroup);
 
@@ -311,30 +475,23 @@ void StackVisualizer::setupUI()
 
 bool StackVisualizer::isEmpty() const
 {
-    return top == -1;
+    return engine.isEmpty();
 }
 
 bool StackVisualizer::isFull() const
 {
-    return top == MAX_SIZE - 1;
+    return engine.isFull();
 }
 
 void StackVisualizer::clear()
 {
-    top = -1;
-    addToHistory(Operation::CLEAR, 0);
-    setStatusMessage("Stack cleared");
-    updateVisualization();
-    emit stateChanged();
+    engine.clear();
 }
 
 QVector<int> StackVisualizer::getCurrentState() const
 {
-    QVector<int> state;
-    for (int i = 0; i <= top; i++) {
-        state.append(arr[i]);
-    }
-    return state;
+    const std::vector<int> state = engine.getCurrentState();
+    return QVector<int>(state.begin(), state.end());
 }
 
 QString StackVisualizer::getStatusMessage() const
@@ -342,6 +499,11 @@ QString StackVisualizer::getStatusMessage() const
     return statusMessage;
 }
 
+QGraphicsScene *StackVisualizer::graphicsScene() const
+{
+    return scene;
+}
+
 void StackVisualizer::setStatusMessage(const QString &message)
 {
     statusMessage = message;
@@ -355,57 +517,139 @@ void StackVisualizer::updateButtons()
     popButton->setEnabled(!isEmpty());
     peekButton->setEnabled(!isEmpty());
     clearButton->setEnabled(!isEmpty());
-    undoButton->setEnabled(currentHistoryIndex >= 0);
-    redoButton->setEnabled(currentHistoryIndex < history.size() - 1);
+    undoButton->setEnabled(engine.history().canUndo());
+    redoButton->setEnabled(engine.history().canRedo());
 }
 
 void StackVisualizer::updateVisualization()
 {
-    scene->clear();
-    
-    const int boxWidth = 60;
-    const int boxHeight = 30;
-    const int spacing = 5;
-    const int startX = 10;
-    const int startY = scene->height() - boxHeight - 10;
-    
-    // Draw stack base
-    scene->addLine(startX - 5, startY + boxHeight + 5, 
-                  startX + boxWidth + 5, startY + boxHeight + 5,
-                  QPen(Qt::black, 2));
-
-    // Draw stack elements
+    DSV_TRACE_SCOPE("StackVisualizer::updateVisualization");
+    PerfHud::UpdateScope timing(perfHud);
+
+    // Only the top MAX_SHOWN_CELLS slots have items. Within that window only
+    // slots written since the last sync, or that just slid in from below,
+    // are touched; popped cells are hidden and kept for reuse
+    const int size = engine.size();
+    const int base = qMax(0, size - MAX_SHOWN_CELLS);
+    const int enteredEnd = qMin(shownBase, size);
+    for (int i = base; i < enteredEnd; i++) {
+        showSlot(i);
+    }
+    for (int i = qMax(qMax(base, syncedFrom), enteredEnd); i < size; i++) {
+        showSlot(i);
+    }
+    for (int i = qMax(size, shownBase); i < shownCount; i++) {
+        Cell &cell = cells[i % MAX_SHOWN_CELLS];
+        if (cell.slot == i) {
+            cell.box->setVisible(false);
+            cell.valueText->setVisible(false);
+            cell.indexText->setVisible(false);
+        }
+    }
+    syncedFrom = size;
+
+    if (shownCount != size || shownBase != base || !baseLine) {
+        shownBase = base;
+        shownCount = size;
+        fitStackInView();
+    }
+}
+
+void StackVisualizer::showSlot(int slot)
+{
+    const int k = slot % MAX_SHOWN_CELLS;
+    while (cells.size() <= k) {
+        createCell();
+    }
+    Cell &cell = cells[k];
+    if (cell.slot != slot) {
+        setCellSlot(cell, slot);
+    }
+    setCellValue(cell, engine.at(slot));
+}
+
+void StackVisualizer::createCell()
+{
     QFont elementFont;
     elementFont.setPointSize(9);
-    
-    for (int i = 0; i <= top; i++) {
-        int y = startY - (i * (boxHeight + spacing));
-        
-        // Draw box
-        QGraphicsRectItem *box = scene->addRect(startX, y, boxWidth, boxHeight);
-        box->setPen(QPen(QColor("#dee2e6")));
-        box->setBrush(QBrush(QColor("#f8f9fa")));
-        
-        // Draw value
-        QGraphicsTextItem *valueText = scene->addText(QString::number(arr[i]));
-        valueText->setFont(elementFont);
-        valueText->setDefaultTextColor(QColor("#2196F3"));
-        
+
+    Cell cell;
+    cell.box = scene->addRect(QRectF(), QPen(QColor("#dee2e6")), QBrush(QColor("#f8f9fa")));
+    cell.valueText = scene->addSimpleText(QString(), elementFont);
+    cell.valueText->setBrush(QColor("#2196F3"));
+    cell.indexText = scene->addSimpleText(QString(), elementFont);
+    cell.indexText->setBrush(Qt::gray);
+    cell.slot = -1;
+    cell.value = 0;
+    cell.valueText->setVisible(false);
+    cells.append(cell);
+}
+
+void StackVisualizer::setCellSlot(Cell &cell, int slot)
+{
+    animator->finish(cell.box);
+    animator->finish(cell.valueText);
+
+    const qreal y = slotY(slot);
+    cell.slot = slot;
+    cell.box->setRect(START_X, y, CELL_WIDTH, CELL_HEIGHT);
+    cell.indexText->setText(QString::number(slot));
+    cell.indexText->setPos(START_X - 20, y + (CELL_HEIGHT - cell.indexText->boundingRect().height()) / 2);
+    // Forces setCellValue to re-center the value in the moved box
+    cell.valueText->setVisible(false);
+}
+
+void StackVisualizer::setCellValue(Cell &cell, int value)
+{
+    // A cell still fading out from a pop is settled before it is reused
+    animator->finish(cell.box);
+    animator->finish(cell.valueText);
+
+    if (!cell.valueText->isVisible() || cell.value != value) {
+        cell.value = value;
+        cell.valueText->setText(QString::number(value));
+
         // Center text in box
-        QRectF textBounds = valueText->boundingRect();
-        valueText->setPos(startX + (boxWidth - textBounds.width()) / 2,
-                         y + (boxHeight - textBounds.height()) / 2);
-        
-        // Draw index
-        QGraphicsTextItem *indexText = scene->addText(QString::number(i));
-        indexText->setFont(elementFont);
-        indexText->setDefaultTextColor(Qt::gray);
-        indexText->setPos(startX - 20, y + (boxHeight - textBounds.height()) / 2);
+        const QRectF box = cell.box->rect();
+        const QRectF textBounds = cell.valueText->boundingRect();
+        cell.valueText->setPos(box.x() + (box.width() - textBounds.width()) / 2,
+                               box.y() + (box.height() - textBounds.height()) / 2);
+    }
+    cell.box->setVisible(true);
+    cell.valueText->setVisible(true);
+    cell.indexText->setVisible(true);
+}
+
+void StackVisualizer::fitStackInView()
+{
+    // Draw stack base once
+    if (!baseLine) {
+        baseLine = scene->addLine(START_X - 5, CELL_HEIGHT + 5,
+                                  START_X + CELL_WIDTH + 5, CELL_HEIGHT + 5,
+                                  QPen(Qt::black, 2));
+        hiddenLabel = scene->addSimpleText(QString());
+        hiddenLabel->setBrush(Qt::gray);
+    }
+
+    // Slots below the window are summarized by a label instead of the base
+    baseLine->setVisible(shownBase == 0);
+    hiddenLabel->setVisible(shownBase > 0);
+    qreal bottomY = CELL_HEIGHT + 6;
+    if (shownBase > 0) {
+        hiddenLabel->setText(QString("%1 more below").arg(QLocale().toString(shownBase)));
+        hiddenLabel->setPos(START_X - 20, slotY(shownBase) + CELL_HEIGHT + 4);
+        bottomY = slotY(shownBase) + CELL_HEIGHT + 4 + hiddenLabel->boundingRect().height();
     }
 
-    // Adjust view
-    QRectF bounds = scene->itemsBoundingRect();
+    // Bounds follow from the layout, no need to walk the items
+    const qreal topY = slotY(qMax(shownCount - 1, shownBase));
+    QRectF bounds(START_X - 20, topY, CELL_WIDTH + 25, bottomY - topY);
     bounds.adjust(-20, -10, 20, 10);
     view->setSceneRect(bounds);
     view->fitInView(bounds, Qt::KeepAspectRatio);
 }
+
+qreal StackVisualizer::slotY(int slot)
+{
+    return -qreal(slot) * (CELL_HEIGHT + CELL_SPACING);
+}
@@ -4,17 +4,27 @@
 #include <QWidget>
 #include <QGraphicsScene>
 #include <QGraphicsView>
-#include <QTimer>
 #include <QStack>
 #include <QString>
-#include <QListWidget>
+#include <QListView>
 #include <QVector>
+#include "stackengine.h"
+#include "historymodel.h"
+#include "sceneanimator.h"
+#include "workstealingpanel.h"
+#include "tracereplaypanel.h"
+#include "sessionlog.h"
+#include "perfhud.h"
 
 class QPushButton;
 class QLineEdit;
 class QLabel;
+class QSpinBox;
+class QGraphicsRectItem;
+class QGraphicsSimpleTextItem;
+class QGraphicsLineItem;
 
-class StackVisualizer : public QWidget
+class StackVisualizer : public QWidget, public EngineObserver
 {
     Q_OBJECT
 
@@ -30,34 +40,46 @@ public:
     void clear();
     QVector<int> getCurrentState() const;
     QString getStatusMessage() const;
+    QGraphicsScene *graphicsScene() const;
     void undoOperation();
     void redoOperation();
+    bool setCapacity(int capacity);
+    void setHistoryEnabled(bool enabled);
 
 signals:
     void statusChanged(const QString &message);
     void stateChanged();
 
+protected:
+    void engineChanged(const EngineEvent &event) override;
+
 private:
-    // Operation history struct
-    struct Operation {
-        enum Type { PUSH, POP, CLEAR } type;
+    StackEngine engine;
+    QString statusMessage;
+
+    // Retained scene items for the top slots of the stack. Cell k shows a
+    // slot congruent to k, so the window slides without recreating items
+    struct Cell {
+        QGraphicsRectItem *box;
+        QGraphicsSimpleTextItem *valueText;
+        QGraphicsSimpleTextItem *indexText;
+        int slot;
         int value;
-        QVector<int> prevState;
     };
-
-    static const int MAX_SIZE = 5;
-    int arr[MAX_SIZE];
-    int top;
-    bool isAnimating;
-    int animationStep;
-    QString statusMessage;
-    QVector<Operation> history;
-    int currentHistoryIndex;
+    QVector<Cell> cells;
+    QGraphicsLineItem *baseLine;
+    QGraphicsSimpleTextItem *hiddenLabel;
+    // Shown slots are [shownBase, shownCount)
+    int shownBase;
+    int shownCount;
+    // Slots below this index still display the engine's value
+    int syncedFrom;
 
     QGraphicsScene *scene;
-    QGraphicsView *view;
-    QTimer *animationTimer;
-    QListWidget *historyList;
+    TimedGraphicsView *view;
+    SceneAnimator *animator;
+    QListView *historyView;
+    HistoryModel *historyModel;
     
     // UI Elements
     QLineEdit *inputField;
@@ -67,16 +89,39 @@ private:
     QPushButton *clearButton;
     QPushButton *undoButton;
     QPushButton *redoButton;
+    QPushButton *recordButton;
+    QSpinBox *capacitySpinBox;
+    QSpinBox *historyBudgetSpinBox;
     QLabel *statusLabel;
+    QLabel *capacityLabel;
+    WorkStealingPanel *workStealingPanel;
+    TraceReplayPanel *traceReplayPanel;
+    bool historyBeforeReplay;
+
+    // Streams every notification to disk while recording
+    SessionWriter recorder;
+    PerfHud *perfHud;
 
     void setupUI();
+    void beginReplay(const OperationTrace &trace);
+    long long replayFrame(OperationTrace &trace, const QElapsedTimer &clock, qint64 deadlineNs);
+    void syncAfterReplay();
+    void endReplay();
+    void toggleRecording();
     void updateVisualization();
     void setStatusMessage(const QString &message);
     void updateButtons();
-    void animateOperation();
-    void addToHistory(Operation::Type type, int value);
+    void animateOperation(const EngineEvent &event);
+    void syncHistoryList();
+    void selectHistoryRow();
     void drawBox(int index, int value, const QString &color = "white");
     void updateCapacityIndicator();
+    void showSlot(int slot);
+    void createCell();
+    void setCellSlot(Cell &cell, int slot);
+    void setCellValue(Cell &cell, int value);
+    void fitStackInView();
+    static qreal slotY(int slot);
 };
 
 #endif // STACKVISUALIZER_H
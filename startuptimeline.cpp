@@ -0,0 +1,59 @@
+#include "startuptimeline.h"
+
+StartupTimeline::StartupTimeline()
+    : firstPaint(-1)
+{
+}
+
+StartupTimeline &StartupTimeline::instance()
+{
+    static StartupTimeline timeline;
+    return timeline;
+}
+
+void StartupTimeline::start()
+{
+    clock.start();
+    phases.clear();
+    firstPaint = -1;
+}
+
+void StartupTimeline::mark(const QString &phase)
+{
+    if (!clock.isValid()) return;
+    phases.append(Phase{phase, clock.nsecsElapsed()});
+}
+
+void StartupTimeline::markFirstPaint()
+{
+    if (!clock.isValid() || firstPaint >= 0) return;
+    mark("First paint");
+    firstPaint = phases.last().endNs;
+}
+
+bool StartupTimeline::hasFirstPaint() const
+{
+    return firstPaint >= 0;
+}
+
+qint64 StartupTimeline::firstPaintNs() const
+{
+    return firstPaint;
+}
+
+QString StartupTimeline::report() const
+{
+    QString text = QString("%1 %2 %3\n").arg("Phase", -32).arg("Took", 10).arg("At", 10);
+    qint64 previous = 0;
+    for (const Phase &phase : phases) {
+        text += QString("%1 %2 %3\n")
+                    .arg(phase.name, -32)
+                    .arg(QString::number((phase.endNs - previous) / 1e6, 'f', 2) + " ms", 10)
+                    .arg(QString::number(phase.endNs / 1e6, 'f', 2) + " ms", 10);
+        previous = phase.endNs;
+    }
+    if (firstPaint >= 0) {
+        text += QString("Time to first paint: %1 ms\n").arg(firstPaint / 1e6, 0, 'f', 2);
+    }
+    return text;
+}
@@ -0,0 +1,40 @@
+#ifndef STARTUPTIMELINE_H
+#define STARTUPTIMELINE_H
+
+#include <QElapsedTimer>
+#include <QString>
+#include <QVector>
+
+// Process-wide record of how long each startup phase took, measured from
+// the top of main(). Phases are marked as they end; first paint is marked
+// by MainWindow once its first frame has been flushed. Marks made later
+// (e.g. a tab built on first activation) are kept too.
+class StartupTimeline
+{
+public:
+    static StartupTimeline &instance();
+
+    void start();
+    void mark(const QString &phase);
+    // Called once the first frame is on screen
+    void markFirstPaint();
+
+    bool hasFirstPaint() const;
+    qint64 firstPaintNs() const;
+    // One line per phase: duration and time since main()
+    QString report() const;
+
+private:
+    struct Phase {
+        QString name;
+        qint64 endNs;
+    };
+
+    QElapsedTimer clock;
+    QVector<Phase> phases;
+    qint64 firstPaint;
+
+    StartupTimeline();
+};
+
+#endif // STARTUPTIMELINE_H
@@ -0,0 +1,151 @@
+#include "tokenizer.h"
+
+namespace {
+enum CharClass : std::uint8_t { Space, Digit, Letter, Dot, Punctuation };
+
+// What a byte starts. Punctuation covers parentheses, commas, operator
+// characters and invalid bytes alike: the token it makes is in TOKENS.
+struct CharInfo {
+    CharClass charClass;
+    Token::Kind kind;
+    // Single-character operator, for Operator
+    std::uint8_t op;
+    // Some longer operator starts with this byte
+    bool extends;
+};
+
+constexpr std::array<CharInfo, 256> buildCharTable()
+{
+    std::array<CharInfo, 256> table{};
+    for (int c = 0; c < 256; c++) {
+        CharInfo info{Punctuation, Token::Invalid, 0, false};
+        if (c == ' ' || c == '\t' || c == '\n' || c == '\r' || c == '\f' || c == '\v') info.charClass = Space;
+        else if (c >= '0' && c <= '9') info.charClass = Digit;
+        else if ((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_') info.charClass = Letter;
+        else if (c == '.') info.charClass = Dot;
+        else if (c == '(') info.kind = Token::LeftParen;
+        else if (c == ')') info.kind = Token::RightParen;
+        else if (c == ',') info.kind = Token::Comma;
+        table[c] = info;
+    }
+    for (int i = 0; i < Operators::COUNT; i++) {
+        const Operators::Info &op = Operators::TABLE[i];
+        CharInfo &info = table[static_cast<unsigned char>(op.symbol[0])];
+        if (op.unary) continue;
+        if (op.symbol.size() > 1) {
+            info.extends = true;
+        } else {
+            info.kind = Token::Operator;
+            info.op = std::uint8_t(i);
+        }
+    }
+    return table;
+}
+constexpr std::array<CharInfo, 256> CHARS = buildCharTable();
+
+inline const CharInfo &charInfo(char ch)
+{
+    return CHARS[static_cast<unsigned char>(ch)];
+}
+
+inline bool isDigit(char ch)
+{
+    return charInfo(ch).charClass == Digit;
+}
+
+inline bool isNameChar(char ch)
+{
+    const CharClass c = charInfo(ch).charClass;
+    return c == Letter || c == Digit;
+}
+}
+
+Tokenizer::Tokenizer(std::string_view source, std::size_t start)
+    : source(source)
+    , cursor(start)
+    , expectOperand(true)
+{
+}
+
+bool Tokenizer::next(Token &token)
+{
+    const char *const begin = source.data();
+    const char *const end = begin + source.size();
+    const char *p = begin + cursor;
+    while (p < end && charInfo(*p).charClass == Space) p++;
+    if (p == end) {
+        cursor = source.size();
+        return false;
+    }
+
+    const char *const start = p;
+    const CharInfo &info = charInfo(*p++);
+    token.op = 0;
+    if (info.charClass == Letter) {
+        while (p < end && isNameChar(*p)) p++;
+        // A name directly followed by '(' is a call
+        const char *peek = p;
+        while (peek < end && charInfo(*peek).charClass == Space) peek++;
+        token.kind = peek < end && *peek == '(' ? Token::Function : Token::Identifier;
+    } else if (info.charClass == Digit || (info.charClass == Dot && p < end && isDigit(*p))) {
+        while (p < end && isDigit(*p)) p++;
+        if (info.charClass == Digit && p < end && *p == '.') {
+            p++;
+            while (p < end && isDigit(*p)) p++;
+        }
+        token.kind = Token::Number;
+    } else {
+        token.kind = info.kind;
+        token.op = info.op;
+        if (*start == '-' && expectOperand) {
+            token.kind = Token::Operator;
+            token.op = std::uint8_t(Operators::NEGATE);
+        } else if (info.extends && p < end) {
+            // Longest match: the longer entries of a group come first
+            for (int op = Operators::FIRST_INDEX[static_cast<unsigned char>(*start)];
+                 op < Operators::COUNT && Operators::TABLE[op].symbol.size() > 1 &&
+                 Operators::TABLE[op].symbol[0] == *start;
+                 op++) {
+                if (Operators::TABLE[op].symbol[1] == *p) {
+                    token.kind = Token::Operator;
+                    token.op = std::uint8_t(op);
+                    p++;
+                    break;
+                }
+            }
+        }
+        // Keep a multi-byte UTF-8 character in one Invalid token
+        while (token.kind == Token::Invalid && p < end && (static_cast<unsigned char>(*p) & 0xc0) == 0x80) p++;
+    }
+
+    token.offset = std::uint32_t(start - begin);
+    token.length = std::uint32_t(p - start);
+    cursor = std::size_t(p - begin);
+    expectOperand = token.kind == Token::Operator || token.kind == Token::LeftParen ||
+                    token.kind == Token::Comma || token.kind == Token::Function;
+    return true;
+}
+
+std::vector<Token> Tokenizer::tokenize(std::string_view source)
+{
+    std::vector<Token> tokens;
+    Tokenizer tokenizer(source);
+    Token token;
+    while (tokenizer.next(token)) {
+        tokens.push_back(token);
+    }
+    return tokens;
+}
+
+bool Tokenizer::isResumePoint(std::string_view source, std::size_t offset)
+{
+    if (offset >= source.size()) return false;
+    const char ch = source[offset];
+    if (ch == '(' || ch == ')') return true;
+    const CharClass current = charInfo(ch).charClass;
+    if (current != Letter && current != Digit) return false;
+    if (offset == 0) return true;
+    // Not inside a name, nor the fraction of a number
+    const CharClass previous = charInfo(source[offset - 1]).charClass;
+    return previous != Letter && previous != Digit && (current == Letter || previous != Dot);
+}
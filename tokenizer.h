@@ -0,0 +1,136 @@
+#ifndef TOKENIZER_H
+#define TOKENIZER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+#include <vector>
+
+// Infix operators. Entries sharing a first character are adjacent, longest
+// symbol first, so the first match is the longest one. The unary minus is
+// only chosen where an operand is expected and is written to postfix as
+// "neg".
+namespace Operators {
+    enum Associativity : std::uint8_t { Left, Right };
+
+    struct Info {
+        std::string_view symbol;
+        // Spelling in postfix output
+        std::string_view postfix;
+        int precedence;
+        Associativity associativity;
+        bool unary;
+    };
+
+    inline constexpr Info TABLE[] = {
+        {"||", "||", 1, Left, false},
+        {"&&", "&&", 2, Left, false},
+        {"==", "==", 3, Left, false},
+        {"!=", "!=", 3, Left, false},
+        {"<=", "<=", 4, Left, false},
+        {"<", "<", 4, Left, false},
+        {">=", ">=", 4, Left, false},
+        {">", ">", 4, Left, false},
+        {"+", "+", 5, Left, false},
+        {"-", "-", 5, Left, false},
+        {"**", "**", 8, Right, false},
+        {"*", "*", 6, Left, false},
+        {"/", "/", 6, Left, false},
+        {"%", "%", 6, Left, false},
+        {"^", "^", 8, Right, false},
+        // Binds looser than the power operators, so -2^2 is -(2^2)
+        {"-", "neg", 7, Right, true},
+    };
+    inline constexpr int COUNT = int(sizeof(TABLE) / sizeof(TABLE[0]));
+    inline constexpr int NONE = 0xff;
+
+    // First binary entry for each leading character, or NONE
+    constexpr std::array<std::uint8_t, 256> buildFirstIndex()
+    {
+        std::array<std::uint8_t, 256> index{};
+        for (auto &entry : index) entry = NONE;
+        for (int i = COUNT - 1; i >= 0; i--) {
+            if (!TABLE[i].unary) index[static_cast<unsigned char>(TABLE[i].symbol[0])] = std::uint8_t(i);
+        }
+        return index;
+    }
+    inline constexpr std::array<std::uint8_t, 256> FIRST_INDEX = buildFirstIndex();
+
+    // Matching scans forward from FIRST_INDEX, so entries sharing a first
+    // character must be adjacent with the longer symbols first
+    constexpr bool isGrouped()
+    {
+        for (int i = 0; i < COUNT; i++) {
+            for (int j = i + 2; j < COUNT; j++) {
+                if (TABLE[i].unary || TABLE[j].unary || TABLE[i].symbol[0] != TABLE[j].symbol[0]) continue;
+                if (TABLE[j - 1].symbol[0] != TABLE[i].symbol[0]) return false;
+            }
+            if (i + 1 < COUNT && !TABLE[i + 1].unary && TABLE[i].symbol[0] == TABLE[i + 1].symbol[0] &&
+                TABLE[i].symbol.size() < TABLE[i + 1].symbol.size()) {
+                return false;
+            }
+        }
+        return true;
+    }
+    static_assert(isGrouped(), "operators sharing a first character must be adjacent, longest first");
+
+    constexpr int find(std::string_view symbol, bool unary)
+    {
+        for (int i = 0; i < COUNT; i++) {
+            if (TABLE[i].symbol == symbol && TABLE[i].unary == unary) return i;
+        }
+        return NONE;
+    }
+    inline constexpr int NEGATE = find("-", true);
+    static_assert(NEGATE != NONE, "the operator table needs a unary minus");
+}
+
+struct Token
+{
+    enum Kind : std::uint8_t { Number, Identifier, Function, Operator, LeftParen, RightParen, Comma, Invalid };
+
+    Kind kind;
+    // Operator only: index into Operators::TABLE
+    std::uint8_t op;
+    // Location in the tokenized source; tokens never copy the text
+    std::uint32_t offset;
+    std::uint32_t length;
+
+    std::string_view text(std::string_view source) const { return source.substr(offset, length); }
+    const Operators::Info &info() const { return Operators::TABLE[op]; }
+
+    bool operator==(const Token &other) const
+    {
+        return offset == other.offset && length == other.length && kind == other.kind && op == other.op;
+    }
+};
+
+// Splits an infix expression into tokens without copying it: numbers
+// (digits with an optional fraction), identifiers, function names (an
+// identifier followed by '('), operators from Operators::TABLE by longest
+// match, parentheses and commas. Whitespace separates tokens and is
+// dropped; any other character becomes an Invalid token of its own.
+class Tokenizer
+{
+public:
+    // Starts at offset start, which must be the start of the source, a
+    // resume point or the byte after an operator
+    explicit Tokenizer(std::string_view source, std::size_t start = 0);
+
+    // Next token, or false at the end of the source
+    bool next(Token &token);
+
+    static std::vector<Token> tokenize(std::string_view source);
+    // A token starts at offset and comes out the same whatever precedes it:
+    // a parenthesis, or the first character of a name or number
+    static bool isResumePoint(std::string_view source, std::size_t offset);
+
+private:
+    std::string_view source;
+    std::size_t cursor;
+    // An operand may start here, so '-' is the unary minus
+    bool expectOperand;
+};
+
+#endif // TOKENIZER_H
@@ -0,0 +1,188 @@
+#include "traceevents.h"
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+namespace {
+
+// Slots are relaxed atomics so that a writer overwriting a slot while
+// writeJson() copies it is not a data race; the copy is discarded instead
+struct Slot {
+    std::atomic<const char *> name{nullptr};
+    std::atomic<std::uint64_t> start{0};
+    std::atomic<std::uint64_t> duration{0};
+};
+
+struct ThreadRing {
+    std::unique_ptr<Slot[]> slots{new Slot[TraceEvents::RING_EVENTS]};
+    // Total events ever recorded; slot index is next % RING_EVENTS
+    std::atomic<std::uint64_t> next{0};
+    std::atomic<std::uint64_t> clearedBefore{0};
+    std::atomic<const char *> threadName{nullptr};
+    unsigned tid = 0;
+};
+
+struct Registry {
+    std::mutex lock;
+    // Rings outlive their threads so exited threads still show up
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    const std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+};
+
+Registry &registry()
+{
+    static Registry instance;
+    return instance;
+}
+
+ThreadRing *registerRing()
+{
+    // The registry keeps the ring alive after its thread exits
+    std::shared_ptr<ThreadRing> ring = std::make_shared<ThreadRing>();
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    ring->tid = unsigned(reg.rings.size() + 1);
+    reg.rings.push_back(ring);
+    return ring.get();
+}
+
+ThreadRing &localRing()
+{
+    thread_local ThreadRing *ring = nullptr;
+    if (!ring) {
+        ring = registerRing();
+    }
+    return *ring;
+}
+
+struct Copied {
+    const char *name;
+    std::uint64_t start;
+    std::uint64_t duration;
+};
+
+void writeEscaped(std::FILE *out, const char *text)
+{
+    for (const char *p = text; *p; p++) {
+        const unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            std::fputc('\\', out);
+            std::fputc(c, out);
+        } else if (c < 0x20) {
+            std::fprintf(out, "\\u%04x", c);
+        } else {
+            std::fputc(c, out);
+        }
+    }
+}
+
+}
+
+std::uint64_t TraceEvents::nowNs()
+{
+    return std::uint64_t(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - registry().epoch).count());
+}
+
+void TraceEvents::record(const char *name, std::uint64_t startNs, std::uint64_t endNs)
+{
+    ThreadRing &ring = localRing();
+    const std::uint64_t index = ring.next.load(std::memory_order_relaxed);
+    Slot &slot = ring.slots[index % RING_EVENTS];
+    // Pairs with the acquire fence in writeJson: a reader that copies any of
+    // the stores below also sees next == index, so it drops this slot
+    std::atomic_thread_fence(std::memory_order_release);
+    slot.name.store(name, std::memory_order_relaxed);
+    slot.start.store(startNs, std::memory_order_relaxed);
+    slot.duration.store(endNs - startNs, std::memory_order_relaxed);
+    ring.next.store(index + 1, std::memory_order_release);
+}
+
+void TraceEvents::setThreadName(const char *name)
+{
+    localRing().threadName.store(name, std::memory_order_relaxed);
+}
+
+void TraceEvents::clear()
+{
+    Registry &reg = registry();
+    std::lock_guard<std::mutex> guard(reg.lock);
+    for (const std::shared_ptr<ThreadRing> &ring : reg.rings) {
+        ring->clearedBefore.store(ring->next.load(std::memory_order_acquire), std::memory_order_relaxed);
+    }
+}
+
+bool TraceEvents::writeJson(const std::string &path, std::string *error)
+{
+    std::vector<std::shared_ptr<ThreadRing>> rings;
+    {
+        Registry &reg = registry();
+        std::lock_guard<std::mutex> guard(reg.lock);
+        rings = reg.rings;
+    }
+
+    std::FILE *out = std::fopen(path.c_str(), "w");
+    if (!out) {
+        if (error) *error = "Cannot create " + path + ": " + std::strerror(errno);
+        return false;
+    }
+
+    std::fputs("{\"displayTimeUnit\":\"ns\",\"traceEvents\":[\n", out);
+    bool first = true;
+    std::vector<Copied> events;
+    for (const std::shared_ptr<ThreadRing> &ring : rings) {
+        const char *threadName = ring->threadName.load(std::memory_order_relaxed);
+        if (threadName) {
+            std::fprintf(out, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":\"",
+                         first ? "" : ",\n", ring->tid);
+            writeEscaped(out, threadName);
+            std::fputs("\"}}", out);
+            first = false;
+        }
+
+        // Copy what is in the ring, then drop anything the owner may have
+        // overwritten while we were copying
+        const std::uint64_t end = ring->next.load(std::memory_order_acquire);
+        const std::uint64_t begin = std::max(ring->clearedBefore.load(std::memory_order_relaxed),
+                                             end > RING_EVENTS ? end - RING_EVENTS : 0);
+        events.clear();
+        for (std::uint64_t i = begin; i < end; i++) {
+            const Slot &slot = ring->slots[i % RING_EVENTS];
+            events.push_back(Copied{slot.name.load(std::memory_order_relaxed),
+                                    slot.start.load(std::memory_order_relaxed),
+                                    slot.duration.load(std::memory_order_relaxed)});
+        }
+        std::atomic_thread_fence(std::memory_order_acquire);
+        const std::uint64_t after = ring->next.load(std::memory_order_relaxed);
+        // The owner may already be storing event `after`, into the slot of
+        // event after - RING_EVENTS, before it publishes next
+        const std::uint64_t valid = after >= RING_EVENTS ? after - RING_EVENTS + 1 : 0;
+        const std::size_t skip = std::size_t(valid > begin ? std::min(valid - begin, end - begin) : 0);
+
+        for (std::size_t i = skip; i < events.size(); i++) {
+            const Copied &event = events[i];
+            if (!event.name) continue;
+            std::fprintf(out, "%s{\"name\":\"", first ? "" : ",\n");
+            writeEscaped(out, event.name);
+            std::fprintf(out, "\",\"cat\":\"dsv\",\"ph\":\"X\",\"ts\":%llu.%03u,\"dur\":%llu.%03u,\"pid\":1,\"tid\":%u}",
+                         static_cast<unsigned long long>(event.start / 1000), unsigned(event.start % 1000),
+                         static_cast<unsigned long long>(event.duration / 1000), unsigned(event.duration % 1000),
+                         ring->tid);
+            first = false;
+        }
+    }
+    std::fputs("\n]}\n", out);
+
+    const bool failed = std::ferror(out) != 0;
+    if (std::fclose(out) != 0 || failed) {
+        if (error) *error = "Writing " + path + " failed";
+        return false;
+    }
+    return true;
+}
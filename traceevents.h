@@ -0,0 +1,57 @@
+#ifndef TRACEEVENTS_H
+#define TRACEEVENTS_H
+
+#include <cstdint>
+#include <string>
+
+// Scoped trace instrumentation that can be written out as Chrome
+// trace_event JSON (chrome://tracing, ui.perfetto.dev).
+//
+//     void StackEngine::push(int value)
+//     {
+//         DSV_TRACE_SCOPE("StackEngine::push");
+//         ...
+//
+// Each thread appends complete events to its own fixed-size ring, so
+// recording takes no lock and keeps only the most recent events. Unless the
+// build defines DSV_TRACING (CMake option of the same name) the macros
+// expand to nothing and instrumented code is unchanged.
+namespace TraceEvents {
+    // Events kept per thread; older ones are overwritten
+    const std::size_t RING_EVENTS = std::size_t(1) << 16;
+
+    std::uint64_t nowNs();
+    // name must be a string literal or otherwise outlive the trace
+    void record(const char *name, std::uint64_t startNs, std::uint64_t endNs);
+    void setThreadName(const char *name);
+    void clear();
+    // Safe to call while other threads keep recording
+    bool writeJson(const std::string &path, std::string *error = nullptr);
+
+    class Scope
+    {
+    public:
+        explicit Scope(const char *name) : name(name), start(nowNs()) {}
+        ~Scope() { record(name, start, nowNs()); }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        const char *name;
+        std::uint64_t start;
+    };
+}
+
+#define DSV_TRACE_CONCAT_INNER(a, b) a##b
+#define DSV_TRACE_CONCAT(a, b) DSV_TRACE_CONCAT_INNER(a, b)
+
+#ifdef DSV_TRACING
+#define DSV_TRACE_SCOPE(name) TraceEvents::Scope DSV_TRACE_CONCAT(dsvTraceScope, __LINE__)(name)
+#define DSV_TRACE_THREAD_NAME(name) TraceEvents::setThreadName(name)
+#else
+#define DSV_TRACE_SCOPE(name) ((void)0)
+#define DSV_TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+#endif // TRACEEVENTS_H
@@ -0,0 +1,156 @@
+#include "tracereplaypanel.h"
+#include <QHBoxLayout>
+#include <QFileDialog>
+#include <QFileInfo>
+#include <QLabel>
+#include <QLocale>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTimer>
+
+namespace {
+// Share of each frame spent replaying; the rest is left for painting
+const double REPLAY_SHARE = 0.75;
+}
+
+TraceReplayPanel::TraceReplayPanel(QWidget *parent)
+    : QGroupBox("Trace Replay", parent)
+    , replayNs(0)
+    , syncNs(0)
+    , frames(0)
+    , started(false)
+{
+    QHBoxLayout *layout = new QHBoxLayout(this);
+    loadButton = new QPushButton("Load Trace...");
+    loadButton->setToolTip("Text trace with one operation per line: push N, pop, enqueue N, dequeue or clear");
+    playButton = new QPushButton("Play");
+    playButton->setEnabled(false);
+    fpsSpinBox = new QSpinBox;
+    fpsSpinBox->setPrefix("Redraw: ");
+    fpsSpinBox->setSuffix(" fps");
+    fpsSpinBox->setRange(1, 240);
+    fpsSpinBox->setValue(30);
+    progressBar = new QProgressBar;
+    progressBar->setRange(0, 1000);
+    progressBar->setValue(0);
+    statsLabel = new QLabel("No trace loaded");
+    layout->addWidget(loadButton);
+    layout->addWidget(playButton);
+    layout->addWidget(fpsSpinBox);
+    layout->addWidget(progressBar);
+    layout->addWidget(statsLabel, 1);
+
+    frameTimer = new QTimer(this);
+    frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(frameTimer, &QTimer::timeout, this, &TraceReplayPanel::replayFrame);
+    connect(loadButton, &QPushButton::clicked, this, &TraceReplayPanel::loadTrace);
+    connect(playButton, &QPushButton::clicked, this, &TraceReplayPanel::togglePlay);
+    connect(fpsSpinBox, QOverload<int>::of(&QSpinBox::valueChanged), this, [this](int fps) {
+        frameTimer->setInterval(1000 / fps);
+    });
+}
+
+void TraceReplayPanel::setHandlers(BeginHandler begin, FrameHandler frame, SyncHandler sync, EndHandler end)
+{
+    beginHandler = begin;
+    frameHandler = frame;
+    syncHandler = sync;
+    endHandler = end;
+}
+
+void TraceReplayPanel::loadTrace()
+{
+    const QString path = QFileDialog::getOpenFileName(this, "Open Operation Trace", QString(),
+                                                      "Traces (*.trace *.txt);;All files (*)");
+    if (path.isEmpty()) return;
+
+    if (started) {
+        finish();
+    }
+
+    std::string error;
+    if (!trace.open(path.toStdString(), &error)) {
+        statsLabel->setText("Cannot load trace: " + QString::fromStdString(error));
+        playButton->setEnabled(false);
+        return;
+    }
+
+    QLocale locale;
+    statsLabel->setText(QString("%1: %2 operations, %3, peak size %4")
+                            .arg(QFileInfo(path).fileName())
+                            .arg(locale.toString(trace.operationCount()))
+                            .arg(locale.formattedDataSize(qint64(trace.bytes())))
+                            .arg(locale.toString(trace.peakSize())));
+    progressBar->setValue(0);
+    playButton->setText("Play");
+    playButton->setEnabled(trace.operationCount() > 0);
+}
+
+void TraceReplayPanel::togglePlay()
+{
+    if (frameTimer->isActive()) {
+        frameTimer->stop();
+        playButton->setText("Resume");
+        return;
+    }
+
+    if (!started) {
+        trace.rewind();
+        replayNs = 0;
+        syncNs = 0;
+        frames = 0;
+        started = true;
+        loadButton->setEnabled(false);
+        if (beginHandler) beginHandler(trace);
+    }
+    frameTimer->start(1000 / fpsSpinBox->value());
+    playButton->setText("Pause");
+}
+
+void TraceReplayPanel::replayFrame()
+{
+    const qint64 budgetNs = qint64(frameTimer->interval() * REPLAY_SHARE * 1000000.0);
+    replayClock.start();
+    if (frameHandler) {
+        frameHandler(trace, replayClock, budgetNs);
+    }
+    replayNs += replayClock.nsecsElapsed();
+
+    QElapsedTimer syncClock;
+    syncClock.start();
+    if (syncHandler) {
+        syncHandler();
+    }
+    syncNs += syncClock.nsecsElapsed();
+    frames++;
+
+    if (trace.atEnd()) {
+        finish();
+    }
+    updateStats();
+}
+
+void TraceReplayPanel::finish()
+{
+    frameTimer->stop();
+    started = false;
+    loadButton->setEnabled(true);
+    playButton->setText("Replay");
+    if (endHandler) endHandler();
+}
+
+void TraceReplayPanel::updateStats()
+{
+    QLocale locale;
+    const long long done = trace.position();
+    const double rate = replayNs > 0 ? done * 1e9 / replayNs : 0.0;
+    progressBar->setValue(trace.operationCount() ? int(done * 1000 / trace.operationCount()) : 0);
+    const double redrawMs = frames > 0 ? syncNs / 1e6 / frames : 0.0;
+    statsLabel->setText(QString("%1%2 / %3 operations - %4 ops/s, redraw %5 ms/frame")
+                            .arg(trace.atEnd() ? "Finished: " : "")
+                            .arg(locale.toString(done))
+                            .arg(locale.toString(trace.operationCount()))
+                            .arg(locale.toString(rate, 'f', 0))
+                            .arg(redrawMs, 0, 'f', 2));
+}
@@ -0,0 +1,64 @@
+#ifndef TRACEREPLAYPANEL_H
+#define TRACEREPLAYPANEL_H
+
+#include <QGroupBox>
+#include <QElapsedTimer>
+#include <functional>
+#include "operationtrace.h"
+
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+
+// Loads a memory-mapped OperationTrace and replays it into the owning
+// visualizer's engine. Each frame replays as many operations as fit in most
+// of the frame interval, then lets the owner redraw once, so the view shows
+// the state at each frame boundary instead of every operation.
+class TraceReplayPanel : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    // begin prepares the engine for the trace; frame applies operations
+    // until the clock passes deadlineNs and returns how many it applied;
+    // sync brings the view up to date after each frame; end restores the
+    // engine once the trace is exhausted. Only frame counts as replay time.
+    typedef std::function<void(const OperationTrace &)> BeginHandler;
+    typedef std::function<long long(OperationTrace &, const QElapsedTimer &, qint64)> FrameHandler;
+    typedef std::function<void()> SyncHandler;
+    typedef std::function<void()> EndHandler;
+
+    explicit TraceReplayPanel(QWidget *parent = nullptr);
+
+    void setHandlers(BeginHandler begin, FrameHandler frame, SyncHandler sync, EndHandler end);
+
+private:
+    OperationTrace trace;
+    BeginHandler beginHandler;
+    FrameHandler frameHandler;
+    SyncHandler syncHandler;
+    EndHandler endHandler;
+    QTimer *frameTimer;
+    QElapsedTimer replayClock;
+    qint64 replayNs;
+    // View syncs, timed apart from the replay
+    qint64 syncNs;
+    int frames;
+    bool started;
+
+    QPushButton *loadButton;
+    QPushButton *playButton;
+    QSpinBox *fpsSpinBox;
+    QProgressBar *progressBar;
+    QLabel *statsLabel;
+
+    void loadTrace();
+    void togglePlay();
+    void replayFrame();
+    void finish();
+    void updateStats();
+};
+
+#endif // TRACEREPLAYPANEL_H
@@ -0,0 +1,147 @@
+#include "workstealingpanel.h"
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QGridLayout>
+#include <QLabel>
+#include <QLocale>
+#include <QProgressBar>
+#include <QPushButton>
+#include <QSpinBox>
+#include <QTimer>
+#include <thread>
+
+WorkStealingPanel::WorkStealingPanel(QWidget *parent)
+    : QGroupBox("Work-Stealing Mode", parent)
+{
+    QVBoxLayout *mainLayout = new QVBoxLayout(this);
+
+    QHBoxLayout *controlsLayout = new QHBoxLayout;
+    workersSpinBox = new QSpinBox;
+    workersSpinBox->setPrefix("Workers: ");
+    workersSpinBox->setRange(1, 64);
+    workersSpinBox->setValue(qBound(2, int(std::thread::hardware_concurrency()), 64));
+    depthSpinBox = new QSpinBox;
+    depthSpinBox->setPrefix("Tree depth: ");
+    depthSpinBox->setRange(0, 24);
+    depthSpinBox->setValue(12);
+    depthSpinBox->setToolTip("Each task spawns two children until this depth is reached");
+    workSpinBox = new QSpinBox;
+    workSpinBox->setPrefix("Work per task: ");
+    workSpinBox->setRange(0, 1000000);
+    workSpinBox->setSingleStep(100);
+    workSpinBox->setValue(500);
+    workSpinBox->setToolTip("Rounds of compute each task performs");
+    startButton = new QPushButton("Start Workers");
+    startButton->setToolTip("Worker 0 pushes and pops at the bottom of its deque; the others steal from the top");
+    controlsLayout->addWidget(workersSpinBox);
+    controlsLayout->addWidget(depthSpinBox);
+    controlsLayout->addWidget(workSpinBox);
+    controlsLayout->addWidget(startButton);
+    mainLayout->addLayout(controlsLayout);
+
+    workersLayout = new QGridLayout;
+    mainLayout->addLayout(workersLayout);
+
+    summaryLabel = new QLabel("Stopped");
+    mainLayout->addWidget(summaryLabel);
+
+    sampleTimer = new QTimer(this);
+    sampleTimer->setTimerType(Qt::PreciseTimer);
+    connect(sampleTimer, &QTimer::timeout, this, &WorkStealingPanel::sample);
+    connect(startButton, &QPushButton::clicked, this, &WorkStealingPanel::toggle);
+}
+
+WorkStealingPanel::~WorkStealingPanel()
+{
+    pool.stop();
+}
+
+void WorkStealingPanel::toggle()
+{
+    if (pool.isRunning()) {
+        sampleTimer->stop();
+        pool.stop();
+        startButton->setText("Start Workers");
+        workersSpinBox->setEnabled(true);
+        depthSpinBox->setEnabled(true);
+        workSpinBox->setEnabled(true);
+        summaryLabel->setText("Stopped");
+        return;
+    }
+
+    WorkStealingPool::Config config;
+    config.workers = workersSpinBox->value();
+    config.treeDepth = depthSpinBox->value();
+    config.workPerTask = workSpinBox->value();
+    rebuildRows(config.workers);
+
+    pool.start(config);
+    lastSample = pool.snapshot();
+    sampleClock.start();
+    sampleTimer->start(16);
+    startButton->setText("Stop Workers");
+    workersSpinBox->setEnabled(false);
+    depthSpinBox->setEnabled(false);
+    workSpinBox->setEnabled(false);
+}
+
+void WorkStealingPanel::rebuildRows(int count)
+{
+    for (const WorkerRow &row : rows) {
+        delete row.name;
+        delete row.depthBar;
+        delete row.stats;
+    }
+    rows.clear();
+
+    // A deque holds at most one pending sibling per tree level plus the root
+    const int maxDepth = depthSpinBox->value() + 2;
+    for (int i = 0; i < count; i++) {
+        WorkerRow row;
+        row.name = new QLabel(i == 0 ? "Worker 0 (owner)" : QString("Worker %1").arg(i));
+        row.depthBar = new QProgressBar;
+        row.depthBar->setRange(0, maxDepth);
+        row.depthBar->setFormat("Depth: %v");
+        row.stats = new QLabel;
+        workersLayout->addWidget(row.name, i, 0);
+        workersLayout->addWidget(row.depthBar, i, 1);
+        workersLayout->addWidget(row.stats, i, 2);
+        rows.append(row);
+    }
+    workersLayout->setColumnStretch(1, 1);
+    workersLayout->setColumnStretch(2, 1);
+}
+
+void WorkStealingPanel::sample()
+{
+    const std::vector<WorkStealingPool::WorkerStats> stats = pool.snapshot();
+    const double seconds = qMax<qint64>(sampleClock.restart(), 1) / 1000.0;
+    QLocale locale;
+
+    std::uint64_t executed = 0;
+    std::uint64_t steals = 0;
+    std::uint64_t failed = 0;
+    double totalRate = 0.0;
+    for (int i = 0; i < rows.size() && i < int(stats.size()); i++) {
+        const WorkStealingPool::WorkerStats &now = stats[i];
+        const WorkStealingPool::WorkerStats &before = lastSample[i];
+        const double rate = (now.executed - before.executed) / seconds;
+        totalRate += rate;
+        executed += now.executed;
+        steals += now.steals;
+        failed += now.failedSteals;
+
+        rows[i].depthBar->setValue(int(qMin<std::int64_t>(now.depth, rows[i].depthBar->maximum())));
+        rows[i].stats->setText(QString("%1 tasks/s - Steals: %2")
+                                   .arg(locale.toString(rate, 'f', 0))
+                                   .arg(locale.toString(qulonglong(now.steals))));
+    }
+    lastSample = stats;
+
+    const std::uint64_t attempts = steals + failed;
+    summaryLabel->setText(QString("Throughput: %1 tasks/s - Executed: %2 - Steals: %3 (%4% of attempts succeed)")
+                              .arg(locale.toString(totalRate, 'f', 0))
+                              .arg(locale.toString(qulonglong(executed)))
+                              .arg(locale.toString(qulonglong(steals)))
+                              .arg(attempts ? 100.0 * steals / attempts : 0.0, 0, 'f', 1));
+}
@@ -0,0 +1,51 @@
+#ifndef WORKSTEALINGPANEL_H
+#define WORKSTEALINGPANEL_H
+
+#include <QGroupBox>
+#include <QElapsedTimer>
+#include <QVector>
+#include "workstealingpool.h"
+
+class QGridLayout;
+class QLabel;
+class QProgressBar;
+class QPushButton;
+class QSpinBox;
+class QTimer;
+
+// Stack tab panel that runs a WorkStealingPool and shows, once per frame,
+// each worker's deque depth, steal count and task throughput.
+class WorkStealingPanel : public QGroupBox
+{
+    Q_OBJECT
+
+public:
+    explicit WorkStealingPanel(QWidget *parent = nullptr);
+    ~WorkStealingPanel();
+
+private:
+    struct WorkerRow {
+        QLabel *name;
+        QProgressBar *depthBar;
+        QLabel *stats;
+    };
+
+    WorkStealingPool pool;
+    std::vector<WorkStealingPool::WorkerStats> lastSample;
+    QElapsedTimer sampleClock;
+    QTimer *sampleTimer;
+
+    QSpinBox *workersSpinBox;
+    QSpinBox *depthSpinBox;
+    QSpinBox *workSpinBox;
+    QPushButton *startButton;
+    QGridLayout *workersLayout;
+    QVector<WorkerRow> rows;
+    QLabel *summaryLabel;
+
+    void toggle();
+    void sample();
+    void rebuildRows(int count);
+};
+
+#endif // WORKSTEALINGPANEL_H
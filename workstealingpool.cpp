@@ -0,0 +1,117 @@
+#include "workstealingpool.h"
+
+WorkStealingPool::WorkStealingPool()
+    : config{0, 0, 0}
+    , running(false)
+    , sink(0)
+{
+}
+
+WorkStealingPool::~WorkStealingPool()
+{
+    stop();
+}
+
+void WorkStealingPool::start(const Config &config)
+{
+    stop();
+
+    this->config = config;
+    workers.clear();
+    for (int i = 0; i < config.workers; i++) {
+        workers.emplace_back(new Worker);
+    }
+
+    running.store(true, std::memory_order_release);
+    for (int i = 0; i < config.workers; i++) {
+        threads.emplace_back(&WorkStealingPool::run, this, i);
+    }
+}
+
+void WorkStealingPool::stop()
+{
+    running.store(false, std::memory_order_release);
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+    threads.clear();
+}
+
+bool WorkStealingPool::isRunning() const
+{
+    return running.load(std::memory_order_acquire);
+}
+
+int WorkStealingPool::workerCount() const
+{
+    return static_cast<int>(workers.size());
+}
+
+std::vector<WorkStealingPool::WorkerStats> WorkStealingPool::snapshot() const
+{
+    std::vector<WorkerStats> stats;
+    stats.reserve(workers.size());
+    for (const std::unique_ptr<Worker> &worker : workers) {
+        stats.push_back(WorkerStats{
+            worker->deque.size(),
+            worker->executed.load(std::memory_order_relaxed),
+            worker->steals.load(std::memory_order_relaxed),
+            worker->failedSteals.load(std::memory_order_relaxed),
+        });
+    }
+    return stats;
+}
+
+void WorkStealingPool::run(int index)
+{
+    Worker &self = *workers[index];
+    std::uint64_t seed = 0x9E3779B97F4A7C15ULL * std::uint64_t(index + 1);
+    Task task = 0;
+
+    while (running.load(std::memory_order_relaxed)) {
+        if (self.deque.take(task)) {
+            execute(self, task);
+            continue;
+        }
+
+        if (index == 0) {
+            // The owner keeps the pool fed with fresh trees
+            self.deque.push(config.treeDepth);
+            continue;
+        }
+
+        // Pick a random victim other than ourselves
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        const int victim = int(seed % std::uint64_t(workers.size() - 1));
+        Worker &other = *workers[victim >= index ? victim + 1 : victim];
+        if (other.deque.steal(task) == ChaseLevDeque<Task>::Stolen) {
+            self.steals.store(self.steals.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            execute(self, task);
+        } else {
+            self.failedSteals.store(self.failedSteals.load(std::memory_order_relaxed) + 1,
+                                    std::memory_order_relaxed);
+            std::this_thread::yield();
+        }
+    }
+}
+
+void WorkStealingPool::execute(Worker &self, Task task)
+{
+    std::uint64_t h = std::uint64_t(task) + 1;
+    for (int i = 0; i < config.workPerTask; i++) {
+        h ^= h >> 33;
+        h *= 0xff51afd7ed558ccdULL;
+    }
+    if (h == 0) {
+        sink.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    if (task > 0) {
+        self.deque.push(task - 1);
+        self.deque.push(task - 1);
+    }
+    // Counters are only written by their own worker
+    self.executed.store(self.executed.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+}
@@ -0,0 +1,71 @@
+#ifndef WORKSTEALINGPOOL_H
+#define WORKSTEALINGPOOL_H
+
+#include "chaselevdeque.h"
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Thread pool in which every worker owns a ChaseLevDeque. Worker 0 is the
+// owner of the workload: whenever its deque runs dry it pushes a new task
+// tree. Each task burns a fixed amount of compute and, until the tree's
+// depth is reached, spawns two children onto its worker's deque. Idle
+// workers steal from the top of a random victim's deque.
+class WorkStealingPool
+{
+public:
+    struct Config {
+        int workers;
+        // Levels of a task tree; a tree has 2^(depth+1) - 1 tasks
+        int treeDepth;
+        // Compute per task, in rounds of a small hash loop
+        int workPerTask;
+    };
+
+    struct WorkerStats {
+        std::int64_t depth;
+        std::uint64_t executed;
+        std::uint64_t steals;
+        // Steal attempts that found the victim empty or lost the race
+        std::uint64_t failedSteals;
+    };
+
+    WorkStealingPool();
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool &) = delete;
+    WorkStealingPool &operator=(const WorkStealingPool &) = delete;
+
+    void start(const Config &config);
+    void stop();
+    bool isRunning() const;
+    int workerCount() const;
+
+    // Any thread; reads only atomics
+    std::vector<WorkerStats> snapshot() const;
+
+private:
+    // One task: levels of children still to spawn
+    typedef std::int32_t Task;
+
+    struct alignas(64) Worker {
+        ChaseLevDeque<Task> deque;
+        std::atomic<std::uint64_t> executed{0};
+        std::atomic<std::uint64_t> steals{0};
+        std::atomic<std::uint64_t> failedSteals{0};
+    };
+
+    Config config;
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+    std::atomic<bool> running;
+    // Keeps the compiler from discarding the task compute
+    std::atomic<std::uint64_t> sink;
+
+    void run(int index);
+    void execute(Worker &self, Task task);
+};
+
+#endif // WORKSTEALINGPOOL_H